@@ -0,0 +1,370 @@
+// Benchmark driver for bigint.
+//
+// The same source is compiled once per configuration so that different
+// builds can be compared on identical workloads. Both exercise versions now
+// share lib/bigint/basic_bigint.hpp, so the interesting axis is the storage
+// backend:
+//
+//   g++ -O2 -std=c++11 bigint.cpp bigint_bench_main.cpp -o bench_string
+//   g++ -O2 -std=c++11 -DBIGINT_STORAGE=vector_storage bigint.cpp
+//       bigint_bench_main.cpp -o bench_vector
+//
+//   ./bench_string --out string.json
+//   ./bench_vector --baseline string.json --threshold 10
+//
+// BIGINT_HEADER still selects another bigint implementation when one needs
+// to be compared against the shared library.
+//
+// parse (from std::string), parse_cstr and print are timed at every size
+// of the sweep, so a parse or print that turns quadratic shows up at the
+// large sizes as a regression against the baseline.
+//
+// Results are printed as JSON, one result object per line. With --baseline,
+// every result is matched against the baseline file by (op, digits) and any
+// slowdown above --threshold percent is flagged; the exit status is then 1.
+
+#ifndef BIGINT_HEADER
+# define BIGINT_HEADER "bigint.hpp"
+#endif
+#include BIGINT_HEADER
+
+#ifndef BIGINT_IMPL_NAME
+# ifdef BIGINT_STORAGE
+#  define BIGINT_STRINGIFY(x) #x
+#  define BIGINT_STRINGIFY_VALUE(x) BIGINT_STRINGIFY(x)
+#  define BIGINT_IMPL_NAME BIGINT_STRINGIFY_VALUE(BIGINT_STORAGE)
+# else
+#  define BIGINT_IMPL_NAME "bigint"
+# endif
+#endif
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Subtraction only exists in the signed implementations; detect it so the
+// same driver still builds against the unsigned ones.
+template <typename B>
+static auto hasSubtraction(int) -> decltype(std::declval<B&>() - std::declval<B&>(), std::true_type());
+template <typename B>
+static std::false_type hasSubtraction(...);
+
+template <typename B>
+static auto hasDigitStats(int) -> decltype(std::declval<B&>().digit_sum(), std::true_type());
+template <typename B>
+static std::false_type hasDigitStats(...);
+
+struct BenchResult {
+    std::string op;
+    size_t digits;
+    size_t iterations;
+    double nsPerOp;
+};
+
+class BigIntBench {
+private:
+    typedef std::chrono::steady_clock clock;
+
+    std::mt19937 rng;
+    double minTime;
+    size_t maxDigits;
+    std::vector<BenchResult> results;
+
+    static const unsigned int SHIFT = 16;
+
+public:
+    BigIntBench(double min_time, size_t max_digits)
+        : rng(42), minTime(min_time), maxDigits(max_digits) {}
+
+    std::string generateRandomNumber(size_t digits) {
+        std::string result(digits, '0');
+        std::uniform_int_distribution<int> dist(0, 9);
+        std::uniform_int_distribution<int> first_digit(1, 9);
+
+        result[0] = static_cast<char>('0' + (digits == 1 ? dist(rng) : first_digit(rng)));
+        for (size_t i = 1; i < digits; i++)
+            result[i] = static_cast<char>('0' + dist(rng));
+        return result;
+    }
+
+    // Runs body() until at least minTime seconds have elapsed and records the
+    // mean cost of one call.
+    template <typename F>
+    void measure(const std::string& op, size_t digits, F body) {
+        size_t iterations = 0;
+        size_t batch = 1;
+        clock::time_point start = clock::now();
+        double elapsed = 0.0;
+
+        while (elapsed < minTime) {
+            for (size_t i = 0; i < batch; i++)
+                body();
+            iterations += batch;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            if (batch < (1u << 20))
+                batch *= 2;
+        }
+        BenchResult r;
+        r.op = op;
+        r.digits = digits;
+        r.iterations = iterations;
+        r.nsPerOp = elapsed * 1e9 / static_cast<double>(iterations);
+        results.push_back(r);
+        std::cerr << "  " << op << " @ " << digits << " digits: "
+                  << r.nsPerOp << " ns/op" << std::endl;
+    }
+
+    template <typename B>
+    void runSubtraction(size_t, B&, B&, B&, std::false_type) {}
+
+    template <typename B>
+    void runSubtraction(size_t digits, B& a, B& b, B& out, std::true_type) {
+        measure("sub", digits, [&]() {
+            out = a - b;
+            doNotOptimize(out);
+        });
+        B negB = -b;
+        measure("add_mixed_sign", digits, [&]() {
+            out = a;
+            out += negB;
+            doNotOptimize(out);
+        });
+    }
+
+    template <typename B>
+    void runDigitStats(size_t, B&, std::false_type) {}
+
+    template <typename B>
+    void runDigitStats(size_t digits, B& a, std::true_type) {
+        measure("digit_sum", digits, [&]() {
+            uint64_t r = a.digit_sum();
+            doNotOptimize(r);
+        });
+        B padded = a << SHIFT;
+        measure("trailing_zeros", digits, [&]() {
+            size_t r = padded.trailing_zeros();
+            doNotOptimize(r);
+        });
+    }
+
+    void runSize(size_t digits) {
+        std::string sa = generateRandomNumber(digits);
+        std::string sb = generateRandomNumber(digits);
+        bigint a(sa), b(sb);
+        bigint out;
+
+        measure("parse", digits, [&]() {
+            bigint x(sa);
+            doNotOptimize(x);
+        });
+        const char* ca = sa.c_str();
+        measure("parse_cstr", digits, [&]() {
+            bigint x(ca);
+            doNotOptimize(x);
+        });
+        measure("copy", digits, [&]() {
+            bigint x(a);
+            doNotOptimize(x);
+        });
+        measure("print", digits, [&]() {
+            std::ostringstream oss;
+            oss << a;
+            doNotOptimize(oss);
+        });
+        measure("add", digits, [&]() {
+            out = a + b;
+            doNotOptimize(out);
+        });
+        measure("add_assign", digits, [&]() {
+            out = a;
+            out += b;
+            doNotOptimize(out);
+        });
+        measure("add_native", digits, [&]() {
+            out = a + 123456789u;
+            doNotOptimize(out);
+        });
+        runSubtraction(digits, a, b, out, decltype(hasSubtraction<bigint>(0))());
+        measure("compare_eq", digits, [&]() {
+            bool r = (a == b);
+            doNotOptimize(r);
+        });
+        measure("compare_lt", digits, [&]() {
+            bool r = (a < b);
+            doNotOptimize(r);
+        });
+        measure("compare_native", digits, [&]() {
+            bool r = (a < 123456789u);
+            doNotOptimize(r);
+        });
+        measure("shift_left", digits, [&]() {
+            out = a << SHIFT;
+            doNotOptimize(out);
+        });
+        measure("shift_right", digits, [&]() {
+            out = a >> SHIFT;
+            doNotOptimize(out);
+        });
+        runDigitStats(digits, a, decltype(hasDigitStats<bigint>(0))());
+        out = a;
+        measure("increment", digits, [&]() {
+            ++out;
+            doNotOptimize(out);
+        });
+    }
+
+    // Native construction produces at most 39 digits, so it is timed once
+    // per native width; string construction and printing are in runSize()
+    // and swept with everything else.
+    void runAll() {
+        measure("construct_uint", 10, [&]() {
+            bigint x(4294967295U);
+            doNotOptimize(x);
+        });
+        measure("construct_u64", 20, [&]() {
+            bigint x(18446744073709551615ULL);
+            doNotOptimize(x);
+        });
+        for (size_t digits = 10; digits <= maxDigits; digits *= 10) {
+            std::cerr << "=== " << digits << " digits ===" << std::endl;
+            runSize(digits);
+        }
+    }
+
+    const std::vector<BenchResult>& getResults() const {
+        return results;
+    }
+};
+
+// Reads back the result lines written by writeJson().
+static bool loadBaseline(const std::string& path, std::map<std::string, double>& out) {
+    std::ifstream in(path.c_str());
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        char op[64];
+        unsigned long digits;
+        unsigned long iterations;
+        double ns;
+        const char* p = std::strstr(line.c_str(), "{\"op\"");
+        if (p && std::sscanf(p, "{\"op\": \"%63[^\"]\", \"digits\": %lu, \"iterations\": %lu, \"ns_per_op\": %lf",
+                             op, &digits, &iterations, &ns) == 4) {
+            std::ostringstream key;
+            key << op << "@" << digits;
+            out[key.str()] = ns;
+        }
+    }
+    return true;
+}
+
+static int writeJson(std::ostream& os, const std::vector<BenchResult>& results,
+                     const std::map<std::string, double>* baseline, double threshold) {
+    int regressions = 0;
+
+    os << "{\n";
+    os << "  \"impl\": \"" << BIGINT_IMPL_NAME << "\",\n";
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        os << "    {\"op\": \"" << r.op << "\", \"digits\": " << r.digits
+           << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp;
+        if (baseline) {
+            std::ostringstream key;
+            key << r.op << "@" << r.digits;
+            std::map<std::string, double>::const_iterator it = baseline->find(key.str());
+            if (it != baseline->end() && it->second > 0) {
+                double delta = (r.nsPerOp - it->second) * 100.0 / it->second;
+                bool regression = delta > threshold;
+                if (regression)
+                    regressions++;
+                os << ", \"baseline_ns_per_op\": " << it->second
+                   << ", \"delta_pct\": " << delta
+                   << ", \"regression\": " << (regression ? "true" : "false");
+            }
+        }
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]";
+    if (baseline)
+        os << ",\n  \"threshold_pct\": " << threshold << ",\n  \"regressions\": " << regressions;
+    os << "\n}\n";
+    return regressions;
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--max-digits N] [--min-time SECONDS]"
+              << " [--out FILE] [--baseline FILE] [--threshold PCT]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t maxDigits = 10000000;
+    double minTime = 0.05;
+    double threshold = 10.0;
+    std::string outPath;
+    std::string baselinePath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (arg == "--max-digits")
+            maxDigits = std::strtoul(argv[++i], NULL, 10);
+        else if (arg == "--min-time")
+            minTime = std::atof(argv[++i]);
+        else if (arg == "--out")
+            outPath = argv[++i];
+        else if (arg == "--baseline")
+            baselinePath = argv[++i];
+        else if (arg == "--threshold")
+            threshold = std::atof(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !loadBaseline(baselinePath, baseline)) {
+        std::cerr << "cannot read baseline " << baselinePath << std::endl;
+        return 2;
+    }
+
+    BigIntBench bench(minTime, maxDigits);
+    bench.runAll();
+
+    const std::map<std::string, double>* base = baselinePath.empty() ? NULL : &baseline;
+    int regressions;
+    if (outPath.empty()) {
+        regressions = writeJson(std::cout, bench.getResults(), base, threshold);
+    } else {
+        std::ofstream out(outPath.c_str());
+        regressions = writeJson(out, bench.getResults(), base, threshold);
+    }
+    if (regressions) {
+        std::cerr << regressions << " regression(s) above " << threshold << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
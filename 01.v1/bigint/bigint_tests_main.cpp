@@ -6,6 +6,26 @@
 #include <random>
 #include <chrono>
 #include <sstream>
+#include <type_traits>
+
+// bool and the character types must not convert to bigint, by the
+// constructor or through a mixed operator; the other integers must.
+template <typename T, typename = void>
+struct adds_to_bigint : std::false_type {};
+template <typename T>
+struct adds_to_bigint<T, decltype((void)(std::declval<const bigint&>() + std::declval<T>()))>
+    : std::true_type {};
+
+static_assert(!std::is_convertible<bool, bigint>::value && !adds_to_bigint<bool>::value, "bool is not a bigint");
+static_assert(!std::is_convertible<char, bigint>::value && !adds_to_bigint<char>::value, "char is not a bigint");
+static_assert(!std::is_convertible<wchar_t, bigint>::value && !adds_to_bigint<wchar_t>::value, "wchar_t is not a bigint");
+static_assert(!std::is_convertible<char16_t, bigint>::value && !adds_to_bigint<char16_t>::value, "char16_t is not a bigint");
+static_assert(!std::is_convertible<char32_t, bigint>::value && !adds_to_bigint<char32_t>::value, "char32_t is not a bigint");
+static_assert(std::is_convertible<int, bigint>::value && adds_to_bigint<int>::value, "int is a bigint");
+static_assert(std::is_convertible<unsigned long long, bigint>::value && adds_to_bigint<unsigned long long>::value,
+              "unsigned long long is a bigint");
+static_assert(std::is_convertible<signed char, bigint>::value && adds_to_bigint<signed char>::value,
+              "signed char is a bigint");
 
 class BigIntTester {
 private:
@@ -88,7 +108,7 @@ public:
         test(bigint("abc").getDigits() == "0", "Test 106: Invalid string");
         test(bigint("12a34").getDigits() == "0", "Test 107: Mixed valid/invalid");
         test(bigint("   ").getDigits() == "0", "Test 108: Spaces");
-        test(bigint("-123").getDigits() == "0", "Test 109: Negative number");
+        test(bigint("-123").getDigits() == "321" && bigint("-123").sign() < 0, "Test 109: Negative number");
         test(bigint("12.34").getDigits() == "0", "Test 110: Decimal number");
         
         // More edge cases for string constructor
@@ -532,7 +552,7 @@ public:
         // Chaos patterns
         for (int i = 8401; i <= 8500; i++) {
             std::string chaos;
-            int seed = rng() % 1000;
+            long long seed = rng() % 1000;
             for (int j = 0; j < 100; j++) {
                 seed = (seed * 1103515245 + 12345) % 1000000;
                 chaos += std::to_string(seed % 10);
@@ -778,6 +798,122 @@ public:
             test(chaos_num.getDigits().size() > 0, "Test " + std::to_string(i) + ": ULTIMATE CHAOS");
         }
         
+        // Test 10001-10100: Native Integer Interop
+        std::cout << "\n=== Native Interop Tests (10001-10100) ===" << std::endl;
+        test(bigint(18446744073709551615ULL).getDigits() == "51615590737044764481", "Test 10001: uint64 max constructor");
+        test(bigint(-5).getDigits() == "5" && bigint(-5) == -5, "Test 10002: Negative int constructor");
+        test(bigint(9223372036854775807LL).to_i64() == 9223372036854775807LL, "Test 10003: int64 round trip");
+        test(bigint("99999999999999999999999").to_u64() == 18446744073709551615ULL, "Test 10004: to_u64 saturates");
+        test(!bigint("18446744073709551616").fits_u64(), "Test 10005: fits_u64 boundary");
+        test((bigint("999") + 1).getDigits() == "0001", "Test 10006: Native add carry");
+        test(bigint("1000") == 1000 && 1000 == bigint("1000"), "Test 10007: Native equality");
+        test(bigint("999") < 1000 && 1000 > bigint("999"), "Test 10008: Native ordering");
+        test((bigint("42") << -1).getDigits() == "4", "Test 10009: Negative shift reverses direction");
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 big128 = static_cast<unsigned __int128>(1) << 100;
+        test(bigint(big128).to_u128() == big128, "Test 10010: uint128 round trip");
+#else
+        test(true, "Test 10010: uint128 round trip (unsupported)");
+#endif
+        for (int i = 10011; i <= 10100; i++) {
+            uint64_t a = (static_cast<uint64_t>(rng()) << 32) | rng();
+            uint64_t b = rng();
+            bigint sum = bigint(a) + b;
+            bool ok = sum == bigint(a) + bigint(b)
+                && (a > UINT64_MAX - b || sum.to_u64() == a + b)
+                && (bigint(a) < b) == (a < b);
+            test(ok, "Test " + std::to_string(i) + ": Random native arithmetic");
+        }
+
+        // Test 10101-10200: Signed Arithmetic
+        std::cout << "\n=== Signed Arithmetic Tests (10101-10200) ===" << std::endl;
+        test((bigint("100") - bigint("1")).getDigits() == "99", "Test 10101: Simple subtraction");
+        test(bigint("1") - bigint("100") == bigint("-99"), "Test 10102: Negative result");
+        test((bigint("-5") + bigint("5")).sign() == 0, "Test 10103: Cancellation gives non-negative zero");
+        test(-bigint("0") == bigint("0") && bigint("-0").sign() == 0, "Test 10104: Negative zero");
+        test(abs(bigint("-42")) == 42, "Test 10105: abs");
+        test(bigint("-10") < bigint("-9") && bigint("-1") < bigint("0"), "Test 10106: Negative ordering");
+        test(bigint(INT64_MIN).to_i64() == INT64_MIN, "Test 10107: int64 min round trip");
+        test(bigint("-99999999999999999999").to_i64() == INT64_MIN, "Test 10108: to_i64 saturates low");
+        bigint self("12345");
+        self -= self;
+        test(self.sign() == 0, "Test 10109: Self subtraction");
+        bigint dec("0");
+        --dec;
+        test(dec == -1 && (dec << 2) == -100, "Test 10110: Decrement below zero and shift");
+        for (int i = 10111; i <= 10200; i++) {
+            int64_t a = static_cast<int64_t>(rng() % 2000000) - 1000000;
+            int64_t b = static_cast<int64_t>(rng() % 2000000) - 1000000;
+            bigint ba(a), bb(b);
+            bool ok = (ba + bb).to_i64() == a + b
+                && (ba - bb).to_i64() == a - b
+                && (ba - b) == a - b
+                && (ba + b) == a + b
+                && (ba < bb) == (a < b)
+                && (ba < b) == (a < b);
+            test(ok, "Test " + std::to_string(i) + ": Random signed arithmetic");
+        }
+
+        // Test 10201-10300: Digit Statistics
+        std::cout << "\n=== Digit Statistics Tests (10201-10300) ===" << std::endl;
+        test(bigint("0").digit_count() == 1 && bigint("0").trailing_zeros() == 0, "Test 10201: Zero statistics");
+        test(bigint("-1200").digit_count() == 4 && bigint("-1200").trailing_zeros() == 2, "Test 10202: Negative statistics");
+        test(bigint("98765").leading_digits(3) == "987", "Test 10203: Leading digits");
+        test(bigint("98765").leading_digits(10) == "98765", "Test 10204: Leading digits past the end");
+        test((bigint("7") << 40).trailing_zeros() == 40, "Test 10205: Trailing zeros across SIMD blocks");
+        for (int i = 10206; i <= 10300; i++) {
+            std::string num = std::to_string(rng() % 9 + 1) + generateRandomNumber(rng() % 200 + 1)
+                + std::string(rng() % 40, '0');
+            uint64_t expected_sum = 0;
+            for (size_t k = 0; k < num.size(); k++)
+                expected_sum += num[k] - '0';
+            size_t expected_tz = num.size() - 1 - num.find_last_not_of('0');
+            bigint b(num);
+            bool ok = b.digit_count() == num.size()
+                && b.digit_sum() == expected_sum
+                && b.trailing_zeros() == expected_tz
+                && b.leading_digits(5) == num.substr(0, 5);
+            test(ok, "Test " + std::to_string(i) + ": Random digit statistics");
+        }
+
+        // Test 10301-10312: Unified Library API
+        std::cout << "\n=== Unified API Tests (10301-10312) ===" << std::endl;
+        test((bigint("4254") << bigint("2")) == bigint("425400"), "Test 10301: Shift left by bigint");
+        test((bigint("4254") >> bigint("60")) == 0, "Test 10302: Shift right by large bigint");
+        test((bigint("42") << bigint("-1")) == 4, "Test 10303: Negative bigint shift");
+        {
+            std::ostringstream oss;
+            bigint("-120").print(oss);
+            test(oss.str() == "-120", "Test 10304: print writes no newline");
+        }
+        {
+            bigint source(generateRandomNumber(100));
+            bigint copy(source);
+            bigint moved(std::move(source));
+            test(moved == copy, "Test 10305: Move construction");
+            bigint target;
+            target = std::move(moved);
+            test(target == copy, "Test 10306: Move assignment");
+            bigint other("7");
+            swap(target, other);
+            test(target == 7 && other == copy, "Test 10307: swap");
+        }
+        test(bigint("5") + bigint("6") + bigint("7") == 18, "Test 10308: Chained rvalue addition");
+        test(basic_bigint<vector_storage>("123") + 1 == 124, "Test 10309: vector_storage backend");
+        test((basic_bigint<vector_storage>("-5") << 1).getDigits() == "05", "Test 10310: vector_storage shift");
+#ifdef __SIZEOF_INT128__
+        {
+            // 2^64 + 3 would truncate to a shift of 3 as a size_t.
+            unsigned __int128 huge = (static_cast<unsigned __int128>(1) << 64) + 3;
+            test((bigint("4254") >> huge) == 0, "Test 10311: Native shift above SIZE_MAX saturates");
+            test((bigint("4254") << -static_cast<__int128>(huge)) == 0,
+                 "Test 10312: Negative native shift above SIZE_MAX saturates");
+        }
+#else
+        test(true, "Test 10311: Native shift above SIZE_MAX (unsupported)");
+        test(true, "Test 10312: Negative native shift above SIZE_MAX (unsupported)");
+#endif
+
         // Final summary
         std::cout << "\n=== TEST SUMMARY ===" << std::endl;
         std::cout << "Passed: " << passed << std::endl;
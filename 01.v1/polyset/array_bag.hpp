@@ -1,20 +1,284 @@
 #pragma once
 
 #include "bag.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
-class array_bag : virtual public bag {
+// Unsorted dynamic array of T. Storage comes from Alloc; only the first
+// size slots hold constructed elements. Trivially copyable T is copied with
+// memcpy on copy, bulk insert and reallocation.
+template <typename T, typename Alloc = std::allocator<T> >
+class basic_array_bag : virtual public basic_bag<T> {
 protected:
-  int *data;
+  typedef std::allocator_traits<Alloc> alloc_traits;
+  typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value> trivial;
+
+  T *data;
   int size;
+  int cap;
+  Alloc alloc;
+
+  void grow(int min_capacity);
+  // Ends the element at i by moving the last one into its place: O(1),
+  // but the order print() shows changes.
+  void remove_at(int i);
 
 public:
-  array_bag();
-  array_bag(const array_bag &);
-  array_bag &operator=(const array_bag &other);
-  ~array_bag();
+  typedef const T *const_iterator;
+
+  basic_array_bag();
+  basic_array_bag(const basic_array_bag &);
+  basic_array_bag(basic_array_bag &&) noexcept;
+  basic_array_bag &operator=(const basic_array_bag &other);
+  basic_array_bag &operator=(basic_array_bag &&other) noexcept;
+  ~basic_array_bag();
 
-  void insert(int);
-  void insert(int *, int);
+  // Exchanges the buffers (and allocators); no element is touched.
+  void swap(basic_array_bag &other) noexcept;
+
+  void insert(T);
+  void insert(T *, int);
   void print() const;
+  void collect(std::vector<T> &) const;
   void clear();
-};
\ No newline at end of file
+
+  // The elements in the order print() lists them.
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  void reserve(int);
+  void shrink_to_fit();
+  int capacity() const;
+
+private:
+  void construct_copies(const T *src, int n, T *dst);
+  void construct_copies(const T *src, int n, T *dst, std::true_type);
+  void construct_copies(const T *src, int n, T *dst, std::false_type);
+  void relocate(T *dst, std::true_type);
+  void relocate(T *dst, std::false_type);
+  void destroy_elements();
+  void reallocate(int new_cap);
+};
+
+template <typename T, typename Alloc>
+basic_array_bag<T, Alloc>::basic_array_bag() {
+  size = 0;
+  cap = 0;
+  data = nullptr;
+}
+
+template <typename T, typename Alloc>
+basic_array_bag<T, Alloc>::basic_array_bag(const basic_array_bag &src)
+	: alloc(alloc_traits::select_on_container_copy_construction(src.alloc)) {
+  size = src.size;
+  cap = src.size;
+  data = cap ? alloc_traits::allocate(alloc, cap) : nullptr;
+  construct_copies(src.data, size, data);
+}
+
+template <typename T, typename Alloc>
+basic_array_bag<T, Alloc>::basic_array_bag(basic_array_bag &&src) noexcept
+	: alloc(std::move(src.alloc)) {
+  data = src.data;
+  size = src.size;
+  cap = src.cap;
+  src.data = nullptr;
+  src.size = 0;
+  src.cap = 0;
+}
+
+template <typename T, typename Alloc>
+basic_array_bag<T, Alloc> &basic_array_bag<T, Alloc>::operator=(const basic_array_bag &src) {
+	if (this != &src) {
+		destroy_elements();
+		if (cap < src.size) {
+			if (data)
+				alloc_traits::deallocate(alloc, data, cap);
+			cap = src.size;
+			data = alloc_traits::allocate(alloc, cap);
+		}
+		construct_copies(src.data, src.size, data);
+		size = src.size;
+	}
+	return *this;
+}
+
+template <typename T, typename Alloc>
+basic_array_bag<T, Alloc> &basic_array_bag<T, Alloc>::operator=(basic_array_bag &&src) noexcept {
+	if (this != &src) {
+		basic_array_bag::clear();
+		swap(src);
+	}
+	return *this;
+}
+
+template <typename T, typename Alloc>
+basic_array_bag<T, Alloc>::~basic_array_bag() {
+	clear();
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::swap(basic_array_bag &other) noexcept {
+	std::swap(data, other.data);
+	std::swap(size, other.size);
+	std::swap(cap, other.cap);
+	std::swap(alloc, other.alloc);
+}
+
+// Reallocates to at least min_capacity, doubling so that a run of n inserts
+// costs O(n) copies in total.
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::grow(int min_capacity) {
+	int new_cap = cap ? cap * 2 : 8;
+	if (new_cap < min_capacity)
+		new_cap = min_capacity;
+	reallocate(new_cap);
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::insert(T item) {
+	if (size == cap)
+		grow(size + 1);
+	alloc_traits::construct(alloc, data + size, std::move(item));
+	size++;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::insert(T *items, int count) {
+	if (count <= 0)
+		return;
+	if (size + count <= cap) {
+		construct_copies(items, count, data + size);
+		size += count;
+		return;
+	}
+	// items may lie in the old buffer, so they are copied into the new one
+	// before the old one is freed.
+	int new_cap = cap ? cap * 2 : 8;
+	if (new_cap < size + count)
+		new_cap = size + count;
+	T *new_data = alloc_traits::allocate(alloc, new_cap);
+	construct_copies(items, count, new_data + size);
+	relocate(new_data, trivial());
+	if (data)
+		alloc_traits::deallocate(alloc, data, cap);
+	data = new_data;
+	cap = new_cap;
+	size += count;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::print() const {
+	for (int i = 0; i < size; i++) {
+		std::cout << data[i] << " ";
+	}
+	std::cout << std::endl;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::collect(std::vector<T> &out) const {
+	out.insert(out.end(), data, data + size);
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::clear() {
+	destroy_elements();
+	if (data)
+		alloc_traits::deallocate(alloc, data, cap);
+	data = nullptr;
+	cap = 0;
+}
+
+template <typename T, typename Alloc>
+typename basic_array_bag<T, Alloc>::const_iterator basic_array_bag<T, Alloc>::begin() const {
+	return data;
+}
+
+template <typename T, typename Alloc>
+typename basic_array_bag<T, Alloc>::const_iterator basic_array_bag<T, Alloc>::end() const {
+	return data + size;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::reserve(int new_cap) {
+	if (new_cap <= cap)
+		return;
+	reallocate(new_cap);
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::shrink_to_fit() {
+	if (cap == size)
+		return;
+	reallocate(size);
+}
+
+template <typename T, typename Alloc>
+int basic_array_bag<T, Alloc>::capacity() const {
+	return cap;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::remove_at(int i) {
+	if (i != size - 1)
+		data[i] = std::move(data[size - 1]);
+	alloc_traits::destroy(alloc, data + size - 1);
+	size--;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::construct_copies(const T *src, int n, T *dst) {
+	construct_copies(src, n, dst, trivial());
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::construct_copies(const T *src, int n, T *dst, std::true_type) {
+	if (n > 0)
+		std::memcpy(static_cast<void *>(dst), src, n * sizeof(T));
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::construct_copies(const T *src, int n, T *dst, std::false_type) {
+	for (int i = 0; i < n; i++)
+		alloc_traits::construct(alloc, dst + i, src[i]);
+}
+
+// Moves the elements into dst and ends their lifetime in data.
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::relocate(T *dst, std::true_type) {
+	if (size > 0)
+		std::memcpy(static_cast<void *>(dst), data, size * sizeof(T));
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::relocate(T *dst, std::false_type) {
+	for (int i = 0; i < size; i++) {
+		alloc_traits::construct(alloc, dst + i, std::move(data[i]));
+		alloc_traits::destroy(alloc, data + i);
+	}
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::destroy_elements() {
+	if (!trivial::value)
+		for (int i = 0; i < size; i++)
+			alloc_traits::destroy(alloc, data + i);
+	size = 0;
+}
+
+template <typename T, typename Alloc>
+void basic_array_bag<T, Alloc>::reallocate(int new_cap) {
+	T *new_data = new_cap ? alloc_traits::allocate(alloc, new_cap) : nullptr;
+	relocate(new_data, trivial());
+	if (data)
+		alloc_traits::deallocate(alloc, data, cap);
+	data = new_data;
+	cap = new_cap;
+}
+
+extern template class basic_array_bag<int>;
+typedef basic_array_bag<int> array_bag;
@@ -1,9 +1,20 @@
 #pragma once
 
-class bag {
+#include <vector>
+
+// Interface of every bag of T. Elements are passed by value, so T should
+// be cheap to copy; the bags of ints use the bag alias below.
+template <typename T>
+class basic_bag {
 public:
-	virtual void insert (int) = 0;
-	virtual void insert (int *, int) = 0;
+	typedef T value_type;
+
+	virtual void insert (T) = 0;
+	virtual void insert (T *, int) = 0;
 	virtual void print() const = 0;
 	virtual void clear() = 0;
-};
\ No newline at end of file
+	// Appends every element to out, in the order print() lists them.
+	virtual void collect(std::vector<T> &out) const = 0;
+};
+
+typedef basic_bag<int> bag;
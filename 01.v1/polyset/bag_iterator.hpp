@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+
+// Const iterator over a bag, built on a cursor that the bag defines:
+//   const T &value() const;
+//   void next();
+//   bool operator==(const Cursor &) const;
+// The cursor holds a position and nothing else, so stepping never
+// allocates. A bag whose elements are decoded rather than stored keeps the
+// current one in its cursor and passes std::input_iterator_tag: the
+// reference then lives only as long as the iterator.
+template <typename Cursor, typename T, typename Category = std::forward_iterator_tag>
+class bag_iterator {
+	private:
+		Cursor cursor;
+
+	public:
+		typedef Category iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T *pointer;
+		typedef const T &reference;
+
+		bag_iterator() : cursor() {}
+		explicit bag_iterator(const Cursor &c) : cursor(c) {}
+
+		reference operator*() const {
+			return cursor.value();
+		}
+		pointer operator->() const {
+			return &cursor.value();
+		}
+		bag_iterator &operator++() {
+			cursor.next();
+			return *this;
+		}
+		bag_iterator operator++(int) {
+			bag_iterator old(*this);
+			cursor.next();
+			return old;
+		}
+		bool operator==(const bag_iterator &other) const {
+			return cursor == other.cursor;
+		}
+		bool operator!=(const bag_iterator &other) const {
+			return !(cursor == other.cursor);
+		}
+};
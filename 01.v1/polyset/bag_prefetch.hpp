@@ -0,0 +1,9 @@
+#pragma once
+
+// Hint that addr will be read soon. A no-op where the builtin is missing;
+// never faults, so it may point past the end of an array.
+#if defined(__GNUC__)
+# define BAG_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+# define BAG_PREFETCH(addr) ((void)0)
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+
+// Tracing policies for basic_tree_bag, picked by template parameter. The
+// bag reports to its policy where it used to print to std::cout:
+//   on_allocate(value, depth)  a node was created, depth links below the root
+//   on_duplicate(value, depth) an insert found value depth links down
+//   on_free(value)             a node was unlinked and returned to the pool
+//   on_clear()                 every node was released at once
+// Copies, moves and swaps are not reported; each bag keeps its own trace.
+
+// The default: every hook is empty and inline, so the calls, and the depth
+// count that feeds them, compile to nothing.
+struct null_trace {
+	template <typename T>
+	void on_allocate(const T &, int) {}
+	template <typename T>
+	void on_duplicate(const T &, int) {}
+	template <typename T>
+	void on_free(const T &) {}
+	void on_clear() {}
+};
+
+// Counts every event and keeps the last N in a ring buffer. Recording is a
+// store into the ring and a few increments: no I/O and no allocation.
+template <typename T, std::size_t N = 1024>
+class ring_trace {
+	public:
+		enum kind { ALLOCATE, DUPLICATE, FREE, CLEAR };
+		struct event {
+			kind type;
+			int depth;	// ALLOCATE and DUPLICATE
+			T value;	// all but CLEAR
+		};
+
+	private:
+		event ring[N];
+		std::size_t recorded;
+		long long allocations;
+		long long frees;
+		long long duplicates;
+		long long clears;
+		long long depth_total;
+		int depth_max;
+
+		void record(kind type, int depth, const T &value) {
+			event &e = ring[recorded % N];
+			e.type = type;
+			e.depth = depth;
+			e.value = value;
+			recorded++;
+		}
+
+	public:
+		ring_trace() : ring(), recorded(0), allocations(0), frees(0), duplicates(0),
+			clears(0), depth_total(0), depth_max(0) {}
+
+		void on_allocate(const T &value, int depth) {
+			allocations++;
+			depth_total += depth;
+			if (depth > depth_max)
+				depth_max = depth;
+			record(ALLOCATE, depth, value);
+		}
+		void on_duplicate(const T &value, int depth) {
+			duplicates++;
+			record(DUPLICATE, depth, value);
+		}
+		void on_free(const T &value) {
+			frees++;
+			record(FREE, 0, value);
+		}
+		void on_clear() {
+			clears++;
+			record(CLEAR, 0, T());
+		}
+
+		// Events held, at most N; at(0) is the oldest.
+		std::size_t size() const {
+			return recorded < N ? recorded : N;
+		}
+		const event &at(std::size_t i) const {
+			return ring[(recorded - size() + i) % N];
+		}
+		// Events ever recorded, including those overwritten.
+		std::size_t total() const {
+			return recorded;
+		}
+
+		long long allocation_count() const {
+			return allocations;
+		}
+		// Nodes freed one at a time; clear() releases the rest in bulk and
+		// counts once in clear_count().
+		long long free_count() const {
+			return frees;
+		}
+		long long duplicate_count() const {
+			return duplicates;
+		}
+		long long clear_count() const {
+			return clears;
+		}
+		// Depth of the deepest node created, and the mean over all of them.
+		int max_depth() const {
+			return depth_max;
+		}
+		double mean_depth() const {
+			return allocations ? (double)depth_total / allocations : 0.0;
+		}
+};
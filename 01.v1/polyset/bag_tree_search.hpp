@@ -0,0 +1,41 @@
+#pragma once
+#include "bag_prefetch.hpp"
+#include <algorithm>
+
+// has_batch() for the binary search trees: any Node with value, l and r.
+// Walks up to 16 searches down the tree in lockstep, one level per round,
+// prefetching each lane's next node so that the misses of a round overlap.
+template <typename Node, typename T, typename Compare>
+void tree_has_batch(const Node *root, const Compare &comp, const T *keys, int n, bool *out) {
+	const int BATCH_LANES = 16;
+	for (int base = 0; base < n; base += BATCH_LANES) {
+		int lanes = std::min(BATCH_LANES, n - base);
+		const Node *current[BATCH_LANES];
+		for (int i = 0; i < lanes; i++) {
+			current[i] = root;
+			out[base + i] = false;
+		}
+		for (bool active = root != nullptr; active; ) {
+			active = false;
+			for (int i = 0; i < lanes; i++) {
+				const Node *c = current[i];
+				if (!c)
+					continue;
+				const T &item = keys[base + i];
+				bool right = comp(c->value, item);
+				bool left = comp(item, c->value);
+				if (!(left | right)) {
+					out[base + i] = true;
+					current[i] = nullptr;
+					continue;
+				}
+				c = right ? c->r : c->l;
+				current[i] = c;
+				if (c) {
+					BAG_PREFETCH(c);
+					active = true;
+				}
+			}
+		}
+	}
+}
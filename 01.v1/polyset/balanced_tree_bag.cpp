@@ -0,0 +1,3 @@
+#include "balanced_tree_bag.hpp"
+
+template class basic_balanced_tree_bag<int>;
@@ -0,0 +1,487 @@
+#pragma once
+
+#include "bag.hpp"
+#include "bag_iterator.hpp"
+#include "node_pool.hpp"
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+// Height-balanced (AVL) binary search tree of T ordered by Compare; two
+// elements are the same when neither is less than the other. Unlike
+// tree_bag, insert and lookup stay O(log n) for sorted input, and every
+// traversal is iterative (nodes keep a parent link) so deep trees cannot
+// overflow the stack. Nodes come from a per-bag node_pool on Alloc and are
+// freed in bulk. Each node also counts its subtree, which answers the
+// order-statistic queries in one root-to-leaf walk.
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T> >
+class basic_balanced_tree_bag : virtual public basic_bag<T> {
+  static_assert(std::is_trivially_destructible<T>::value,
+    "tree bag nodes are released without running destructors");
+
+protected:
+  struct node {
+    node *l;
+    node *r;
+    node *p;
+    T value;
+    int height;
+    int size;	// nodes in this subtree
+  };
+  node *tree;
+  node_pool<node, Alloc> pool;
+  Compare comp;
+
+  static node *leftmost(node *);
+  static node *successor(node *);
+
+  struct cursor {
+    node *current;
+    const T &value() const { return current->value; }
+    void next() { current = successor(current); }
+    bool operator==(const cursor &other) const { return current == other.current; }
+  };
+
+  // Adds item unless it is present, in one walk; true when it was added.
+  bool try_insert(T item);
+  // Unlinks the node holding item, returns it to the pool and rebalances
+  // from its parent up.
+  bool try_erase(T item);
+
+public:
+  typedef bag_iterator<cursor, T> const_iterator;
+
+  basic_balanced_tree_bag();
+  basic_balanced_tree_bag(const basic_balanced_tree_bag &);
+  basic_balanced_tree_bag(basic_balanced_tree_bag &&) noexcept;
+  virtual ~basic_balanced_tree_bag();
+  basic_balanced_tree_bag &operator=(const basic_balanced_tree_bag &);
+  basic_balanced_tree_bag &operator=(basic_balanced_tree_bag &&) noexcept;
+
+  // Exchanges the roots and the node pools; no node is copied.
+  void swap(basic_balanced_tree_bag &other) noexcept;
+
+  virtual void insert(T);
+  virtual void insert(T *array, int size);
+  virtual void print() const;
+  virtual void collect(std::vector<T> &) const;
+  virtual void clear();
+
+  // In order, smallest first.
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  // Order statistics, each O(log n). Values come back through out, and the
+  // bool is false when there is none.
+  int size() const;
+  // Number of elements less than item.
+  int rank(T item) const;
+  // The element with k smaller ones, for 0 <= k < size().
+  bool select(int k, T &out) const;
+  // Number of elements in [low, high]; 0 when low > high.
+  int count_range(T low, T high) const;
+  // Smallest element not less than item, and greater than item.
+  bool lower_bound(T item, T &out) const;
+  bool upper_bound(T item, T &out) const;
+
+private:
+  static int height(node *);
+  static int size_of(node *);
+  // Recomputes height and subtree size from the children.
+  static void update_node(node *);
+  int count_below(const T &item, bool inclusive) const;
+  node *first_above(const T &item, bool inclusive) const;
+  void replace_child(node *parent, node *old_child, node *new_child);
+  node *rotate_left(node *);
+  node *rotate_right(node *);
+  void rebalance(node *);
+
+  static int count_nodes(node *);
+  node *copy_tree(node *);
+};
+
+template <typename T, typename Compare, typename Alloc>
+basic_balanced_tree_bag<T, Compare, Alloc>::basic_balanced_tree_bag() {
+	tree = nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_balanced_tree_bag<T, Compare, Alloc>::basic_balanced_tree_bag(const basic_balanced_tree_bag &src) : comp(src.comp) {
+	pool.reserve(count_nodes(src.tree));
+	tree = copy_tree(src.tree);
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_balanced_tree_bag<T, Compare, Alloc>::basic_balanced_tree_bag(basic_balanced_tree_bag &&src) noexcept : comp(src.comp) {
+	tree = nullptr;
+	swap(src);
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_balanced_tree_bag<T, Compare, Alloc>::~basic_balanced_tree_bag() {
+	tree = nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_balanced_tree_bag<T, Compare, Alloc> &basic_balanced_tree_bag<T, Compare, Alloc>::operator=(const basic_balanced_tree_bag &src) {
+	if (this != &src) {
+		pool.release();
+		comp = src.comp;
+		pool.reserve(count_nodes(src.tree));
+		tree = copy_tree(src.tree);
+	}
+	return *this;
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_balanced_tree_bag<T, Compare, Alloc> &basic_balanced_tree_bag<T, Compare, Alloc>::operator=(basic_balanced_tree_bag &&src) noexcept {
+	if (this != &src) {
+		basic_balanced_tree_bag::clear();
+		swap(src);
+	}
+	return *this;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::swap(basic_balanced_tree_bag &other) noexcept {
+	std::swap(tree, other.tree);
+	pool.swap(other.pool);
+	std::swap(comp, other.comp);
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::insert(T item) {
+	try_insert(item);
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_balanced_tree_bag<T, Compare, Alloc>::try_insert(T item) {
+	node *parent = nullptr;
+	node *current = tree;
+	bool left = false;
+	while (current) {
+		left = comp(item, current->value);
+		bool right = comp(current->value, item);
+		if (!(left | right))
+			return false;
+		parent = current;
+		current = left ? current->l : current->r;
+	}
+
+	node *new_node = pool.allocate();
+	new_node->l = nullptr;
+	new_node->r = nullptr;
+	new_node->p = parent;
+	new_node->value = item;
+	new_node->height = 1;
+	new_node->size = 1;
+	if (parent == nullptr)
+		tree = new_node;
+	else if (left)
+		parent->l = new_node;
+	else
+		parent->r = new_node;
+	rebalance(parent);
+	return true;
+}
+
+// A node with two children takes its successor's value and the successor,
+// which has no left child, is unlinked instead.
+template <typename T, typename Compare, typename Alloc>
+bool basic_balanced_tree_bag<T, Compare, Alloc>::try_erase(T item) {
+	node *current = tree;
+	while (current) {
+		bool left = comp(item, current->value);
+		bool right = comp(current->value, item);
+		if (!(left | right))
+			break;
+		current = left ? current->l : current->r;
+	}
+	if (current == nullptr)
+		return false;
+	if (current->l && current->r) {
+		node *next = leftmost(current->r);
+		current->value = next->value;
+		current = next;
+	}
+	node *parent = current->p;
+	replace_child(parent, current, current->l ? current->l : current->r);
+	pool.deallocate(current);
+	rebalance(parent);
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::insert(T *items, int count) {
+	for (int i = 0; i < count; i++) {
+		insert(items[i]);
+	}
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::print() const {
+	for (node *current = leftmost(tree); current; current = successor(current)) {
+		std::cout << current->value << " ";
+	}
+	std::cout << std::endl;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::collect(std::vector<T> &out) const {
+	for (node *current = leftmost(tree); current; current = successor(current))
+		out.push_back(current->value);
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::clear() {
+	pool.release();
+	tree = nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::const_iterator basic_balanced_tree_bag<T, Compare, Alloc>::begin() const {
+	cursor c = { leftmost(tree) };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::const_iterator basic_balanced_tree_bag<T, Compare, Alloc>::end() const {
+	cursor c = { nullptr };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::size() const {
+	return size_of(tree);
+}
+
+// Every step right passes a node and its whole left subtree.
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::count_below(const T &item, bool inclusive) const {
+	int count = 0;
+	node *current = tree;
+	while (current) {
+		if (inclusive ? !comp(item, current->value) : comp(current->value, item)) {
+			count += size_of(current->l) + 1;
+			current = current->r;
+		} else {
+			current = current->l;
+		}
+	}
+	return count;
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::rank(T item) const {
+	return count_below(item, false);
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_balanced_tree_bag<T, Compare, Alloc>::select(int k, T &out) const {
+	if (k < 0 || k >= size())
+		return false;
+	node *current = tree;
+	while (true) {
+		int left = size_of(current->l);
+		if (k == left)
+			break;
+		if (k < left) {
+			current = current->l;
+		} else {
+			k -= left + 1;
+			current = current->r;
+		}
+	}
+	out = current->value;
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::count_range(T low, T high) const {
+	if (comp(high, low))
+		return 0;
+	return count_below(high, true) - count_below(low, false);
+}
+
+// Lowest node above item (or at it, when inclusive).
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::node *basic_balanced_tree_bag<T, Compare, Alloc>::first_above(const T &item, bool inclusive) const {
+	node *best = nullptr;
+	node *current = tree;
+	while (current) {
+		if (inclusive ? !comp(current->value, item) : comp(item, current->value)) {
+			best = current;
+			current = current->l;
+		} else {
+			current = current->r;
+		}
+	}
+	return best;
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_balanced_tree_bag<T, Compare, Alloc>::lower_bound(T item, T &out) const {
+	node *found = first_above(item, true);
+	if (found)
+		out = found->value;
+	return found != nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_balanced_tree_bag<T, Compare, Alloc>::upper_bound(T item, T &out) const {
+	node *found = first_above(item, false);
+	if (found)
+		out = found->value;
+	return found != nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::node *basic_balanced_tree_bag<T, Compare, Alloc>::leftmost(node *current) {
+	if (current == nullptr)
+		return nullptr;
+	while (current->l)
+		current = current->l;
+	return current;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::node *basic_balanced_tree_bag<T, Compare, Alloc>::successor(node *current) {
+	if (current->r)
+		return leftmost(current->r);
+	while (current->p && current->p->r == current)
+		current = current->p;
+	return current->p;
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::height(node *current) {
+	return current ? current->height : 0;
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::size_of(node *current) {
+	return current ? current->size : 0;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::update_node(node *current) {
+	int hl = height(current->l);
+	int hr = height(current->r);
+	current->height = 1 + (hl > hr ? hl : hr);
+	current->size = 1 + size_of(current->l) + size_of(current->r);
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::replace_child(node *parent, node *old_child, node *new_child) {
+	if (parent == nullptr)
+		tree = new_child;
+	else if (parent->l == old_child)
+		parent->l = new_child;
+	else
+		parent->r = new_child;
+	if (new_child)
+		new_child->p = parent;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::node *basic_balanced_tree_bag<T, Compare, Alloc>::rotate_left(node *x) {
+	node *y = x->r;
+	x->r = y->l;
+	if (y->l)
+		y->l->p = x;
+	replace_child(x->p, x, y);
+	y->l = x;
+	x->p = y;
+	update_node(x);
+	update_node(y);
+	return y;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::node *basic_balanced_tree_bag<T, Compare, Alloc>::rotate_right(node *x) {
+	node *y = x->l;
+	x->l = y->r;
+	if (y->r)
+		y->r->p = x;
+	replace_child(x->p, x, y);
+	y->r = x;
+	x->p = y;
+	update_node(x);
+	update_node(y);
+	return y;
+}
+
+// Restores the AVL invariant on the path from current up to the root. The
+// walk never stops early, so the subtree sizes along the path are refreshed
+// after every insert and erase.
+template <typename T, typename Compare, typename Alloc>
+void basic_balanced_tree_bag<T, Compare, Alloc>::rebalance(node *current) {
+	while (current) {
+		update_node(current);
+		int balance = height(current->l) - height(current->r);
+		if (balance > 1) {
+			if (height(current->l->l) < height(current->l->r))
+				rotate_left(current->l);
+			current = rotate_right(current);
+		} else if (balance < -1) {
+			if (height(current->r->r) < height(current->r->l))
+				rotate_right(current->r);
+			current = rotate_left(current);
+		}
+		current = current->p;
+	}
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_balanced_tree_bag<T, Compare, Alloc>::count_nodes(node *current) {
+	int count = 0;
+	for (current = leftmost(current); current; current = successor(current))
+		count++;
+	return count;
+}
+
+// Pre-order copy that walks source and destination in lockstep, using the
+// parent links of both to climb back up.
+template <typename T, typename Compare, typename Alloc>
+typename basic_balanced_tree_bag<T, Compare, Alloc>::node *basic_balanced_tree_bag<T, Compare, Alloc>::copy_tree(node *src) {
+	if (src == nullptr)
+		return nullptr;
+	node *root = pool.allocate();
+	*root = *src;
+	root->l = nullptr;
+	root->r = nullptr;
+	root->p = nullptr;
+
+	node *s = src;
+	node *d = root;
+	while (true) {
+		node *next = nullptr;
+		if (s->l && d->l == nullptr)
+			next = s->l;
+		else if (s->r && d->r == nullptr)
+			next = s->r;
+		if (next) {
+			node *copy = pool.allocate();
+			*copy = *next;
+			copy->l = nullptr;
+			copy->r = nullptr;
+			copy->p = d;
+			if (next == s->l)
+				d->l = copy;
+			else
+				d->r = copy;
+			s = next;
+			d = copy;
+		} else {
+			if (s == src)
+				break;
+			s = s->p;
+			d = d->p;
+		}
+	}
+	return root;
+}
+
+extern template class basic_balanced_tree_bag<int>;
+typedef basic_balanced_tree_bag<int> balanced_tree_bag;
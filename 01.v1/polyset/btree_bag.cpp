@@ -0,0 +1,3 @@
+#include "btree_bag.hpp"
+
+template class basic_btree_bag<int>;
@@ -0,0 +1,579 @@
+#pragma once
+
+#include "bag.hpp"
+#include "bag_iterator.hpp"
+#include "bag_prefetch.hpp"
+#include "node_pool.hpp"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+// In-node searches of basic_btree_bag over the first count of slots keys.
+// rank() is the number of keys less than item, upper() the number not
+// greater. The int specialization compares every slot with SSE2 and relies
+// on the padding past count being INT_MAX and on slots being a multiple of
+// four.
+template <typename T, typename Compare>
+struct btree_search {
+	static int rank(const T *keys, int, int count, const T &item, const Compare &comp) {
+		int r = 0;
+		while (r < count && comp(keys[r], item))
+			r++;
+		return r;
+	}
+	static int upper(const T *keys, int, int count, const T &item, const Compare &comp) {
+		int i = 0;
+		while (i < count && !comp(item, keys[i]))
+			i++;
+		return i;
+	}
+};
+
+#ifdef __SSE2__
+template <>
+struct btree_search<int, std::less<int> > {
+	static int horizontal_sum(__m128i v) {
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+		return _mm_cvtsi128_si32(v);
+	}
+	// The padding never counts, and the comparison masks (-1 per hit) are
+	// summed without a branch.
+	static int rank(const int *keys, int slots, int, int item, const std::less<int> &) {
+		__m128i needle = _mm_set1_epi32(item);
+		__m128i acc = _mm_setzero_si128();
+		for (int i = 0; i < slots; i += 4) {
+			__m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+			acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(k, needle));
+		}
+		return horizontal_sum(acc);
+	}
+	// The clamp covers item == INT_MAX, where the padding compares equal.
+	static int upper(const int *keys, int slots, int count, int item, const std::less<int> &) {
+		__m128i needle = _mm_set1_epi32(item);
+		__m128i acc = _mm_setzero_si128();
+		for (int i = 0; i < slots; i += 4) {
+			__m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+			acc = _mm_sub_epi32(acc, _mm_cmpgt_epi32(k, needle));
+		}
+		return std::min(slots - horizontal_sum(acc), count);
+	}
+};
+#endif
+
+// B+ tree of T ordered by Compare, with 256-byte nodes (four cache lines).
+// The node capacities follow from sizeof(T): for int, up to 60 keys per
+// leaf and 20 keys / 21 children per inner node, so a lookup at 10^7 keys
+// visits five nodes instead of the ~27 of the AVL tree; 64-bit keys get 30
+// and 15. Keys live in the leaves, which are chained left to right; unused
+// key slots hold the largest T (INT_MAX for int) so the SSE2 in-node search
+// of the int tree can scan every slot without looking at the count.
+//
+// A batch insert into an empty tree, or one that is large relative to the
+// tree, sorts the keys and bulk loads the tree bottom-up. Duplicates are
+// dropped, like balanced_tree_bag.
+//
+// Erasing takes the key out of its leaf and leaves the separators alone;
+// nodes are not merged, so a leaf may run empty and stay in the chain. Once
+// the leaves are less than a quarter full on average the tree is rebuilt
+// with bulk_load(), which costs O(n) after at least 3n/4 erases.
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T> >
+class basic_btree_bag : virtual public basic_bag<T> {
+  static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+    "B+ tree keys are copied into node slots and released without destructors");
+
+protected:
+  struct node {
+    int count;
+    bool leaf;
+  };
+
+  static const int NODE_BYTES = 256;
+  static const int LEAF_FIT = (int)((NODE_BYTES - sizeof(node) - sizeof(void *)) / sizeof(T));
+  static const int INNER_FIT = (int)((NODE_BYTES - sizeof(node) - sizeof(void *))
+    / (sizeof(T) + sizeof(void *)));
+  static const int LEAF_KEYS = LEAF_FIT > 4 ? LEAF_FIT : 4;
+  static const int INNER_KEYS = INNER_FIT > 4 ? INNER_FIT : 4;
+  static const int MAX_DEPTH = 32;
+
+  struct leaf_node : node {
+    leaf_node *next;
+    T keys[LEAF_KEYS];
+  };
+  struct inner_node : node {
+    T keys[INNER_KEYS];
+    node *children[INNER_KEYS + 1];
+  };
+  typedef btree_search<T, Compare> search;
+
+  node *root;
+  leaf_node *first;
+  int key_count;
+  int leaf_count;
+  node_pool<leaf_node, Alloc> leaves;
+  node_pool<inner_node, Alloc> inners;
+  Compare comp;
+
+  static T padding();
+  // Number of keys of the leaf smaller than item.
+  int leaf_rank(const leaf_node *, const T &item) const;
+  // Index of the child whose range holds item: the number of separators
+  // not greater than item.
+  int child_index(const inner_node *, const T &item) const;
+  const leaf_node *find_leaf(const node *, const T &item) const;
+  bool same(const T &a, const T &b) const;
+  static void prefetch_node(const node *);
+  // l, or the first leaf after it that holds a key.
+  static const leaf_node *nonempty_from(const leaf_node *l);
+
+  struct cursor {
+    const leaf_node *leaf;
+    int i;
+    const T &value() const { return leaf->keys[i]; }
+    void next() {
+      if (++i == leaf->count) {
+        leaf = nonempty_from(leaf->next);
+        i = 0;
+      }
+    }
+    bool operator==(const cursor &other) const { return leaf == other.leaf && i == other.i; }
+  };
+
+  // Adds item unless it is present, in one descent; true when it was added.
+  bool try_insert(T item);
+  bool try_erase(T item);
+
+public:
+  typedef bag_iterator<cursor, T> const_iterator;
+
+  basic_btree_bag();
+  basic_btree_bag(const basic_btree_bag &);
+  basic_btree_bag(basic_btree_bag &&) noexcept;
+  virtual ~basic_btree_bag();
+  basic_btree_bag &operator=(const basic_btree_bag &);
+  basic_btree_bag &operator=(basic_btree_bag &&) noexcept;
+
+  // Exchanges the roots, leaf chains and node pools; no node is copied.
+  void swap(basic_btree_bag &other) noexcept;
+
+  virtual void insert(T);
+  virtual void insert(T *array, int size);
+  virtual void print() const;
+  virtual void collect(std::vector<T> &) const;
+  virtual void clear();
+
+  // Along the leaf chain, smallest first.
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  int size() const;
+
+private:
+  leaf_node *new_leaf();
+  inner_node *new_inner();
+  void bulk_load(const T *sorted, int n);
+  void copy_keys(T *out) const;
+};
+
+template <typename T, typename Compare, typename Alloc>
+basic_btree_bag<T, Compare, Alloc>::basic_btree_bag() {
+	root = nullptr;
+	first = nullptr;
+	key_count = 0;
+	leaf_count = 0;
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_btree_bag<T, Compare, Alloc>::basic_btree_bag(const basic_btree_bag &src) : comp(src.comp) {
+	root = nullptr;
+	first = nullptr;
+	key_count = 0;
+	leaf_count = 0;
+	std::vector<T> keys(src.key_count);
+	src.copy_keys(keys.data());
+	bulk_load(keys.data(), src.key_count);
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_btree_bag<T, Compare, Alloc>::basic_btree_bag(basic_btree_bag &&src) noexcept : comp(src.comp) {
+	root = nullptr;
+	first = nullptr;
+	key_count = 0;
+	leaf_count = 0;
+	swap(src);
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_btree_bag<T, Compare, Alloc>::~basic_btree_bag() {
+	root = nullptr;
+	first = nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_btree_bag<T, Compare, Alloc> &basic_btree_bag<T, Compare, Alloc>::operator=(const basic_btree_bag &src) {
+	if (this != &src) {
+		std::vector<T> keys(src.key_count);
+		src.copy_keys(keys.data());
+		clear();
+		comp = src.comp;
+		bulk_load(keys.data(), src.key_count);
+	}
+	return *this;
+}
+
+template <typename T, typename Compare, typename Alloc>
+basic_btree_bag<T, Compare, Alloc> &basic_btree_bag<T, Compare, Alloc>::operator=(basic_btree_bag &&src) noexcept {
+	if (this != &src) {
+		basic_btree_bag::clear();
+		swap(src);
+	}
+	return *this;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::swap(basic_btree_bag &other) noexcept {
+	std::swap(root, other.root);
+	std::swap(first, other.first);
+	std::swap(key_count, other.key_count);
+	std::swap(leaf_count, other.leaf_count);
+	leaves.swap(other.leaves);
+	inners.swap(other.inners);
+	std::swap(comp, other.comp);
+}
+
+template <typename T, typename Compare, typename Alloc>
+T basic_btree_bag<T, Compare, Alloc>::padding() {
+	return std::numeric_limits<T>::is_specialized ? std::numeric_limits<T>::max() : T();
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_btree_bag<T, Compare, Alloc>::leaf_rank(const leaf_node *n, const T &item) const {
+	return search::rank(n->keys, LEAF_KEYS, n->count, item, comp);
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_btree_bag<T, Compare, Alloc>::child_index(const inner_node *n, const T &item) const {
+	return search::upper(n->keys, INNER_KEYS, n->count, item, comp);
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_btree_bag<T, Compare, Alloc>::same(const T &a, const T &b) const {
+	return !comp(a, b) && !comp(b, a);
+}
+
+// Descends to the leaf that holds item if it is present, pulling in the
+// later cache lines of each child before it is searched.
+template <typename T, typename Compare, typename Alloc>
+const typename basic_btree_bag<T, Compare, Alloc>::leaf_node *basic_btree_bag<T, Compare, Alloc>::find_leaf(const node *n, const T &item) const {
+	while (!n->leaf) {
+		const inner_node *in = static_cast<const inner_node *>(n);
+		n = in->children[child_index(in, item)];
+		prefetch_node(n);
+	}
+	return static_cast<const leaf_node *>(n);
+}
+
+// Requests all four cache lines of a node.
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::prefetch_node(const node *n) {
+	const char *bytes = reinterpret_cast<const char *>(n);
+	BAG_PREFETCH(bytes);
+	BAG_PREFETCH(bytes + 64);
+	BAG_PREFETCH(bytes + 128);
+	BAG_PREFETCH(bytes + 192);
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_btree_bag<T, Compare, Alloc>::leaf_node *basic_btree_bag<T, Compare, Alloc>::new_leaf() {
+	leaf_node *n = leaves.allocate();
+	leaf_count++;
+	n->count = 0;
+	n->leaf = true;
+	n->next = nullptr;
+	std::fill(n->keys, n->keys + LEAF_KEYS, padding());
+	return n;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_btree_bag<T, Compare, Alloc>::inner_node *basic_btree_bag<T, Compare, Alloc>::new_inner() {
+	inner_node *n = inners.allocate();
+	n->count = 0;
+	n->leaf = false;
+	std::fill(n->keys, n->keys + INNER_KEYS, padding());
+	std::fill(n->children, n->children + INNER_KEYS + 1, (node *)nullptr);
+	return n;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::insert(T item) {
+	try_insert(item);
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_btree_bag<T, Compare, Alloc>::try_insert(T item) {
+	if (root == nullptr) {
+		leaf_node *l = new_leaf();
+		l->keys[0] = item;
+		l->count = 1;
+		root = first = l;
+		key_count = 1;
+		return true;
+	}
+
+	inner_node *path[MAX_DEPTH];
+	int slot[MAX_DEPTH];
+	int d = 0;
+	node *n = root;
+	while (!n->leaf) {
+		inner_node *in = static_cast<inner_node *>(n);
+		path[d] = in;
+		slot[d] = child_index(in, item);
+		n = in->children[slot[d++]];
+	}
+
+	leaf_node *l = static_cast<leaf_node *>(n);
+	int r = leaf_rank(l, item);
+	if (r < l->count && same(l->keys[r], item))
+		return false;
+	key_count++;
+	if (l->count < LEAF_KEYS) {
+		std::copy_backward(l->keys + r, l->keys + l->count, l->keys + l->count + 1);
+		l->keys[r] = item;
+		l->count++;
+		return true;
+	}
+
+	// Split the full leaf in two halves and hand the first key of the
+	// right half up as the new separator. An append past the last leaf
+	// leaves the old leaf full, so ascending inserts pack the leaves.
+	T keys[LEAF_KEYS + 1];
+	std::copy(l->keys, l->keys + r, keys);
+	keys[r] = item;
+	std::copy(l->keys + r, l->keys + LEAF_KEYS, keys + r + 1);
+	int half = (r == LEAF_KEYS && l->next == nullptr) ? LEAF_KEYS : (LEAF_KEYS + 1) / 2;
+	leaf_node *right = new_leaf();
+	std::copy(keys + half, keys + LEAF_KEYS + 1, right->keys);
+	right->count = LEAF_KEYS + 1 - half;
+	std::copy(keys, keys + half, l->keys);
+	std::fill(l->keys + half, l->keys + LEAF_KEYS, padding());
+	l->count = half;
+	right->next = l->next;
+	l->next = right;
+
+	T sep = right->keys[0];
+	node *new_child = right;
+	while (d > 0) {
+		inner_node *p = path[--d];
+		int i = slot[d];
+		if (p->count < INNER_KEYS) {
+			std::copy_backward(p->keys + i, p->keys + p->count, p->keys + p->count + 1);
+			std::copy_backward(p->children + i + 1, p->children + p->count + 1, p->children + p->count + 2);
+			p->keys[i] = sep;
+			p->children[i + 1] = new_child;
+			p->count++;
+			return true;
+		}
+
+		// Split the full inner node; its middle separator moves up.
+		T seps[INNER_KEYS + 1];
+		node *children[INNER_KEYS + 2];
+		std::copy(p->keys, p->keys + i, seps);
+		seps[i] = sep;
+		std::copy(p->keys + i, p->keys + INNER_KEYS, seps + i + 1);
+		std::copy(p->children, p->children + i + 1, children);
+		children[i + 1] = new_child;
+		std::copy(p->children + i + 1, p->children + INNER_KEYS + 1, children + i + 2);
+
+		int mid = (INNER_KEYS + 1) / 2;
+		inner_node *q = new_inner();
+		std::copy(seps + mid + 1, seps + INNER_KEYS + 1, q->keys);
+		std::copy(children + mid + 1, children + INNER_KEYS + 2, q->children);
+		q->count = INNER_KEYS - mid;
+		std::copy(seps, seps + mid, p->keys);
+		std::fill(p->keys + mid, p->keys + INNER_KEYS, padding());
+		std::copy(children, children + mid + 1, p->children);
+		std::fill(p->children + mid + 1, p->children + INNER_KEYS + 1, (node *)nullptr);
+		p->count = mid;
+
+		sep = seps[mid];
+		new_child = q;
+	}
+
+	inner_node *new_root = new_inner();
+	new_root->keys[0] = sep;
+	new_root->children[0] = root;
+	new_root->children[1] = new_child;
+	new_root->count = 1;
+	root = new_root;
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_btree_bag<T, Compare, Alloc>::try_erase(T item) {
+	if (root == nullptr)
+		return false;
+	node *n = root;
+	while (!n->leaf) {
+		inner_node *in = static_cast<inner_node *>(n);
+		n = in->children[child_index(in, item)];
+	}
+	leaf_node *l = static_cast<leaf_node *>(n);
+	int r = leaf_rank(l, item);
+	if (r >= l->count || !same(l->keys[r], item))
+		return false;
+	std::copy(l->keys + r + 1, l->keys + l->count, l->keys + r);
+	l->count--;
+	l->keys[l->count] = padding();
+	key_count--;
+	if (key_count == 0) {
+		clear();
+	} else if (4 * key_count < leaf_count * LEAF_KEYS) {
+		std::vector<T> keys(key_count);
+		copy_keys(keys.data());
+		clear();
+		bulk_load(keys.data(), (int)keys.size());
+	}
+	return true;
+}
+
+// Small batches go through insert(); otherwise the batch is sorted, merged
+// with the current keys and the tree rebuilt bottom-up in O(n).
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::insert(T *items, int count) {
+	if (count <= 0)
+		return;
+	if (root != nullptr && count < key_count / 8) {
+		for (int i = 0; i < count; i++)
+			insert(items[i]);
+		return;
+	}
+	std::vector<T> keys(key_count + count);
+	copy_keys(keys.data());
+	std::copy(items, items + count, keys.begin() + key_count);
+	std::sort(keys.begin() + key_count, keys.end(), comp);
+	std::inplace_merge(keys.begin(), keys.begin() + key_count, keys.end(), comp);
+	Compare c = comp;
+	keys.erase(std::unique(keys.begin(), keys.end(),
+		[c](const T &a, const T &b) { return !c(a, b); }), keys.end());
+	clear();
+	bulk_load(keys.data(), (int)keys.size());
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::print() const {
+	for (const leaf_node *l = first; l; l = l->next) {
+		for (int i = 0; i < l->count; i++)
+			std::cout << l->keys[i] << " ";
+	}
+	std::cout << std::endl;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::collect(std::vector<T> &out) const {
+	for (const leaf_node *l = first; l; l = l->next)
+		out.insert(out.end(), l->keys, l->keys + l->count);
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::clear() {
+	leaves.release();
+	inners.release();
+	root = nullptr;
+	first = nullptr;
+	key_count = 0;
+	leaf_count = 0;
+}
+
+template <typename T, typename Compare, typename Alloc>
+const typename basic_btree_bag<T, Compare, Alloc>::leaf_node *basic_btree_bag<T, Compare, Alloc>::nonempty_from(const leaf_node *l) {
+	while (l && l->count == 0)
+		l = l->next;
+	return l;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_btree_bag<T, Compare, Alloc>::const_iterator basic_btree_bag<T, Compare, Alloc>::begin() const {
+	cursor c = { nonempty_from(first), 0 };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_btree_bag<T, Compare, Alloc>::const_iterator basic_btree_bag<T, Compare, Alloc>::end() const {
+	cursor c = { nullptr, 0 };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_btree_bag<T, Compare, Alloc>::size() const {
+	return key_count;
+}
+
+// Builds the tree from sorted, unique keys into an empty bag: leaves are
+// filled evenly left to right, then each level of inner nodes is built over
+// the one below until a single root remains.
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::bulk_load(const T *sorted, int n) {
+	if (n <= 0)
+		return;
+	int leaf_total = (n + LEAF_KEYS - 1) / LEAF_KEYS;
+	leaves.reserve(leaf_total);
+	std::vector<node *> level;
+	std::vector<T> mins;
+	leaf_node *prev = nullptr;
+	for (int i = 0, pos = 0; i < leaf_total; i++) {
+		int take = n / leaf_total + (i < n % leaf_total);
+		leaf_node *l = new_leaf();
+		std::copy(sorted + pos, sorted + pos + take, l->keys);
+		l->count = take;
+		if (prev)
+			prev->next = l;
+		else
+			first = l;
+		prev = l;
+		level.push_back(l);
+		mins.push_back(sorted[pos]);
+		pos += take;
+	}
+
+	while (level.size() > 1) {
+		int m = (int)level.size();
+		int parent_total = (m + INNER_KEYS) / (INNER_KEYS + 1);
+		inners.reserve(parent_total);
+		std::vector<node *> parents;
+		std::vector<T> parent_mins;
+		for (int i = 0, c = 0; i < parent_total; i++) {
+			int take = m / parent_total + (i < m % parent_total);
+			inner_node *in = new_inner();
+			for (int j = 0; j < take; j++) {
+				in->children[j] = level[c + j];
+				if (j > 0)
+					in->keys[j - 1] = mins[c + j];
+			}
+			in->count = take - 1;
+			parents.push_back(in);
+			parent_mins.push_back(mins[c]);
+			c += take;
+		}
+		level.swap(parents);
+		mins.swap(parent_mins);
+	}
+	root = level[0];
+	key_count = n;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_btree_bag<T, Compare, Alloc>::copy_keys(T *out) const {
+	for (const leaf_node *l = first; l; l = l->next)
+		out = std::copy(l->keys, l->keys + l->count, out);
+}
+
+extern template class basic_btree_bag<int>;
+typedef basic_btree_bag<int> btree_bag;
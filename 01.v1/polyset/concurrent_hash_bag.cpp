@@ -0,0 +1,450 @@
+#include "concurrent_hash_bag.hpp"
+#include "bag_prefetch.hpp"
+#include <algorithm>
+#include <iostream>
+
+const int concurrent_hash_bag::EMPTY;
+const int concurrent_hash_bag::DELETED;
+
+// Same mix as searchable_hash_bag: the shard comes from the top bits, the
+// home slot from the low bits.
+uint64_t concurrent_hash_bag::hash(int item) {
+	uint64_t h = (uint64_t)(uint32_t)item * 0x9E3779B97F4A7C15ull;
+	return h ^ (h >> 32);
+}
+
+int concurrent_hash_bag::shard_of(uint64_t h) {
+	return (int)(h >> (64 - SHARD_BITS));
+}
+
+concurrent_hash_bag::table *concurrent_hash_bag::new_table(size_t slot_count) {
+	table *t = new table;
+	t->slots = new std::atomic<int>[slot_count];
+	for (size_t i = 0; i < slot_count; i++)
+		t->slots[i].store(EMPTY, std::memory_order_relaxed);
+	t->mask = slot_count - 1;
+	t->retired = nullptr;
+	return t;
+}
+
+void concurrent_hash_bag::free_tables(table *t) {
+	while (t) {
+		table *next = t->retired;
+		delete[] t->slots;
+		delete t;
+		t = next;
+	}
+}
+
+// A slot goes from EMPTY to a key once and then only between keys and
+// DELETED, so a reader that meets EMPTY has passed every slot of the probe
+// chain that held a key when it looked. DELETED never equals item: the two
+// reserved values are kept in the shard's flags.
+bool concurrent_hash_bag::find_in(const table *t, int item, uint64_t h) {
+	for (size_t i = (size_t)h & t->mask; ; i = (i + 1) & t->mask) {
+		int v = t->slots[i].load(std::memory_order_acquire);
+		if (v == item)
+			return true;
+		if (v == EMPTY)
+			return false;
+	}
+}
+
+// Caller holds the shard lock and knows item is absent. Fills the first
+// free slot of the probe chain and reports whether it was a tombstone.
+bool concurrent_hash_bag::place(table *t, int item, uint64_t h) {
+	size_t i = (size_t)h & t->mask;
+	int v;
+	while ((v = t->slots[i].load(std::memory_order_relaxed)) != EMPTY && v != DELETED)
+		i = (i + 1) & t->mask;
+	t->slots[i].store(item, std::memory_order_release);
+	return v == DELETED;
+}
+
+// Linear probing degrades past three quarters full.
+size_t concurrent_hash_bag::slots_for(size_t count) {
+	size_t slots = MIN_SLOTS;
+	while (slots / 4 * 3 < count)
+		slots *= 2;
+	return slots;
+}
+
+// Spreads threads over the reader slots round-robin, in order of first use.
+int concurrent_hash_bag::reader_slot_index() {
+	static std::atomic<unsigned> next(0);
+	static thread_local int index = (int)(next.fetch_add(1, std::memory_order_relaxed) % READER_SLOTS);
+	return index;
+}
+
+// Counts the reader in, then checks that the epoch has not moved: a
+// reader counted under an epoch already left behind could be missed by
+// the check in advance_epoch().
+concurrent_hash_bag::pin::pin(const concurrent_hash_bag *b) : bag(b), slot(reader_slot_index()) {
+	for (;;) {
+		unsigned e = bag->epoch.load(std::memory_order_seq_cst);
+		parity = (int)(e & 1);
+		bag->readers[slot].pins[parity].fetch_add(1, std::memory_order_seq_cst);
+		if (bag->epoch.load(std::memory_order_seq_cst) == e)
+			return;
+		bag->readers[slot].pins[parity].fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+// The original holds the epoch, so the copy can join it without a check.
+concurrent_hash_bag::pin::pin(const pin &other) : bag(other.bag), slot(other.slot), parity(other.parity) {
+	if (bag)
+		bag->readers[slot].pins[parity].fetch_add(1, std::memory_order_relaxed);
+}
+
+concurrent_hash_bag::pin &concurrent_hash_bag::pin::operator=(const pin &other) {
+	if (other.bag)
+		other.bag->readers[other.slot].pins[other.parity].fetch_add(1, std::memory_order_relaxed);
+	if (bag)
+		bag->readers[slot].pins[parity].fetch_sub(1, std::memory_order_release);
+	bag = other.bag;
+	slot = other.slot;
+	parity = other.parity;
+	return *this;
+}
+
+concurrent_hash_bag::pin::~pin() {
+	if (bag)
+		bag->readers[slot].pins[parity].fetch_sub(1, std::memory_order_release);
+}
+
+// A table retired in epoch e was unpublished before the epoch reached
+// e + 1, so only readers of e or earlier can hold it; it is freed when the
+// epoch moves to e + 2, which needs the readers of e gone. The readers of
+// e - 1 were gone before e was reached, so one counter per parity is
+// enough.
+void concurrent_hash_bag::retire(table *t) {
+	std::lock_guard<std::mutex> guard(retire_lock);
+	int parity = (int)(epoch.load(std::memory_order_relaxed) & 1);
+	t->retired = limbo[parity];
+	limbo[parity] = t;
+	advance_epoch();
+}
+
+bool concurrent_hash_bag::advance_epoch() {
+	unsigned e = epoch.load(std::memory_order_relaxed);
+	int before = (int)((e + 1) & 1);
+	for (int i = 0; i < READER_SLOTS; i++)
+		if (readers[i].pins[before].load(std::memory_order_seq_cst) != 0)
+			return false;
+	free_tables(limbo[before]);
+	limbo[before] = nullptr;
+	epoch.store(e + 1, std::memory_order_seq_cst);
+	return true;
+}
+
+// The flag standing in for a reserved value, or null for any other item.
+std::atomic<bool> *concurrent_hash_bag::flag_for(shard &s, int item) {
+	if (item == EMPTY)
+		return &s.holds_empty;
+	if (item == DELETED)
+		return &s.holds_deleted;
+	return nullptr;
+}
+
+// Builds the new table privately and publishes it with one store; readers
+// still holding the old one find every key there that they could have found
+// before the rebuild started. The table is rebuilt when count keys would
+// not fit next to the tombstones, at the size count needs.
+void concurrent_hash_bag::grow(shard &s, size_t count) {
+	table *old = s.current.load(std::memory_order_relaxed);
+	size_t slots = slots_for(count);
+	if (slots <= old->mask + 1 && count + s.tombstones <= (old->mask + 1) / 4 * 3)
+		return;
+	table *t = new_table(slots);
+	for (size_t i = 0; i <= old->mask; i++) {
+		int v = old->slots[i].load(std::memory_order_relaxed);
+		if (v != EMPTY && v != DELETED)
+			place(t, v, hash(v));
+	}
+	s.tombstones = 0;
+	s.current.store(t, std::memory_order_seq_cst);
+	retire(old);
+}
+
+bool concurrent_hash_bag::insert_locked(shard &s, int item, uint64_t h) {
+	if (std::atomic<bool> *flag = flag_for(s, item)) {
+		if (flag->load(std::memory_order_relaxed))
+			return false;
+		flag->store(true, std::memory_order_release);
+		s.count.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+	table *t = s.current.load(std::memory_order_relaxed);
+	if (find_in(t, item, h))
+		return false;
+	int count = s.count.load(std::memory_order_relaxed);
+	if ((size_t)count + s.tombstones + 1 > (t->mask + 1) / 4 * 3) {
+		grow(s, 2 * (size_t)count + 1);
+		t = s.current.load(std::memory_order_relaxed);
+	}
+	if (place(t, item, h))
+		s.tombstones--;
+	s.count.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void concurrent_hash_bag::copy_from(const concurrent_hash_bag &other) {
+	std::vector<int> values;
+	other.collect(values);
+	insert_unique(values.data(), (int)values.size());
+}
+
+void concurrent_hash_bag::init_shards() {
+	for (int i = 0; i < SHARDS; i++) {
+		shards[i].current.store(new_table(MIN_SLOTS), std::memory_order_relaxed);
+		shards[i].count.store(0, std::memory_order_relaxed);
+		shards[i].holds_empty.store(false, std::memory_order_relaxed);
+		shards[i].holds_deleted.store(false, std::memory_order_relaxed);
+		shards[i].tombstones = 0;
+	}
+	for (int i = 0; i < READER_SLOTS; i++) {
+		readers[i].pins[0].store(0, std::memory_order_relaxed);
+		readers[i].pins[1].store(0, std::memory_order_relaxed);
+	}
+	epoch.store(0, std::memory_order_relaxed);
+	limbo[0] = nullptr;
+	limbo[1] = nullptr;
+}
+
+concurrent_hash_bag::concurrent_hash_bag() {
+	init_shards();
+}
+
+concurrent_hash_bag::concurrent_hash_bag(const concurrent_hash_bag &other) {
+	init_shards();
+	copy_from(other);
+}
+
+concurrent_hash_bag &concurrent_hash_bag::operator=(const concurrent_hash_bag &other) {
+	if (this != &other) {
+		clear();
+		reclaim();
+		copy_from(other);
+	}
+	return *this;
+}
+
+concurrent_hash_bag::~concurrent_hash_bag() {
+	for (int i = 0; i < SHARDS; i++)
+		free_tables(shards[i].current.load(std::memory_order_relaxed));
+	free_tables(limbo[0]);
+	free_tables(limbo[1]);
+}
+
+void concurrent_hash_bag::insert(int item) {
+	insert_unique(item);
+}
+
+bool concurrent_hash_bag::insert_unique(int item) {
+	uint64_t h = hash(item);
+	shard &s = shards[shard_of(h)];
+	std::lock_guard<std::mutex> guard(s.lock);
+	return insert_locked(s, item, h);
+}
+
+void concurrent_hash_bag::insert(int *items, int count) {
+	insert_unique(items, count);
+}
+
+// Buckets the items by shard, then takes each lock once, grows the shard
+// once for its whole bucket and inserts the bucket.
+int concurrent_hash_bag::insert_unique(int *items, int count) {
+	if (count <= 0)
+		return 0;
+	std::vector<int> start(SHARDS + 1, 0);
+	for (int i = 0; i < count; i++)
+		start[shard_of(hash(items[i])) + 1]++;
+	for (int i = 0; i < SHARDS; i++)
+		start[i + 1] += start[i];
+	std::vector<int> bucketed(count);
+	std::vector<int> fill(start.begin(), start.end() - 1);
+	for (int i = 0; i < count; i++)
+		bucketed[fill[shard_of(hash(items[i]))]++] = items[i];
+
+	int inserted = 0;
+	for (int i = 0; i < SHARDS; i++) {
+		if (start[i] == start[i + 1])
+			continue;
+		shard &s = shards[i];
+		std::lock_guard<std::mutex> guard(s.lock);
+		grow(s, (size_t)s.count.load(std::memory_order_relaxed) + (start[i + 1] - start[i]));
+		for (int j = start[i]; j < start[i + 1]; j++)
+			inserted += insert_locked(s, bucketed[j], hash(bucketed[j]));
+	}
+	return inserted;
+}
+
+void concurrent_hash_bag::print() const {
+	std::vector<int> values;
+	collect(values);
+	for (size_t i = 0; i < values.size(); i++)
+		std::cout << values[i] << " ";
+	std::cout << std::endl;
+}
+
+void concurrent_hash_bag::collect(std::vector<int> &out) const {
+	for (int i = 0; i < SHARDS; i++) {
+		const shard &s = shards[i];
+		std::lock_guard<std::mutex> guard(s.lock);
+		if (s.holds_empty.load(std::memory_order_relaxed))
+			out.push_back(EMPTY);
+		if (s.holds_deleted.load(std::memory_order_relaxed))
+			out.push_back(DELETED);
+		const table *t = s.current.load(std::memory_order_relaxed);
+		for (size_t j = 0; j <= t->mask; j++) {
+			int v = t->slots[j].load(std::memory_order_relaxed);
+			if (v != EMPTY && v != DELETED)
+				out.push_back(v);
+		}
+	}
+}
+
+void concurrent_hash_bag::cursor::next() {
+	if (stage == 2)
+		j++;
+	else
+		stage++;
+	settle();
+}
+
+// The table is loaded before the DELETED flag is reported, so that next()
+// can step from stage 1 straight to slot 0.
+void concurrent_hash_bag::cursor::settle() {
+	for (; si < SHARDS; si++, stage = 0) {
+		const shard &s = bag->shards[si];
+		if (stage == 0) {
+			if (s.holds_empty.load(std::memory_order_acquire)) {
+				current = EMPTY;
+				return;
+			}
+			stage = 1;
+		}
+		if (stage == 1) {
+			t = s.current.load(std::memory_order_seq_cst);
+			j = 0;
+			if (s.holds_deleted.load(std::memory_order_acquire)) {
+				current = DELETED;
+				return;
+			}
+			stage = 2;
+		}
+		for (; j <= t->mask; j++) {
+			int v = t->slots[j].load(std::memory_order_acquire);
+			if (v != EMPTY && v != DELETED) {
+				current = v;
+				return;
+			}
+		}
+	}
+	t = nullptr;
+	j = 0;
+	current = 0;
+}
+
+concurrent_hash_bag::const_iterator concurrent_hash_bag::begin() const {
+	cursor c = { this, 0, 0, nullptr, 0, 0, pin(this) };
+	c.settle();
+	return const_iterator(c);
+}
+
+concurrent_hash_bag::const_iterator concurrent_hash_bag::end() const {
+	cursor c = { this, SHARDS, 0, nullptr, 0, 0, pin() };
+	return const_iterator(c);
+}
+
+void concurrent_hash_bag::clear() {
+	for (int i = 0; i < SHARDS; i++) {
+		shard &s = shards[i];
+		std::lock_guard<std::mutex> guard(s.lock);
+		table *old = s.current.load(std::memory_order_relaxed);
+		s.current.store(new_table(MIN_SLOTS), std::memory_order_seq_cst);
+		s.holds_empty.store(false, std::memory_order_release);
+		s.holds_deleted.store(false, std::memory_order_release);
+		s.tombstones = 0;
+		s.count.store(0, std::memory_order_relaxed);
+		retire(old);
+	}
+}
+
+bool concurrent_hash_bag::has(int item) const {
+	uint64_t h = hash(item);
+	const shard &s = shards[shard_of(h)];
+	if (item == EMPTY)
+		return s.holds_empty.load(std::memory_order_acquire);
+	if (item == DELETED)
+		return s.holds_deleted.load(std::memory_order_acquire);
+	pin hold(this);
+	return find_in(s.current.load(std::memory_order_seq_cst), item, h);
+}
+
+// Hashes up to BATCH_LANES keys and prefetches the home slot of each before
+// probing any of them, as searchable_hash_bag does. One pin covers the
+// whole batch.
+void concurrent_hash_bag::has_batch(const int *keys, int n, bool *out) const {
+	const int BATCH_LANES = 16;
+	pin hold(this);
+	uint64_t h[BATCH_LANES];
+	const table *t[BATCH_LANES];
+	for (int base = 0; base < n; base += BATCH_LANES) {
+		int lanes = std::min(BATCH_LANES, n - base);
+		for (int i = 0; i < lanes; i++) {
+			h[i] = hash(keys[base + i]);
+			t[i] = shards[shard_of(h[i])].current.load(std::memory_order_seq_cst);
+			BAG_PREFETCH(&t[i]->slots[(size_t)h[i] & t[i]->mask]);
+		}
+		for (int i = 0; i < lanes; i++) {
+			int item = keys[base + i];
+			if (item == EMPTY)
+				out[base + i] = shards[shard_of(h[i])].holds_empty.load(std::memory_order_acquire);
+			else if (item == DELETED)
+				out[base + i] = shards[shard_of(h[i])].holds_deleted.load(std::memory_order_acquire);
+			else
+				out[base + i] = find_in(t[i], item, h[i]);
+		}
+	}
+}
+
+bool concurrent_hash_bag::erase(int item) {
+	uint64_t h = hash(item);
+	shard &s = shards[shard_of(h)];
+	std::lock_guard<std::mutex> guard(s.lock);
+	if (std::atomic<bool> *flag = flag_for(s, item)) {
+		if (!flag->load(std::memory_order_relaxed))
+			return false;
+		flag->store(false, std::memory_order_release);
+		s.count.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	table *t = s.current.load(std::memory_order_relaxed);
+	for (size_t i = (size_t)h & t->mask; ; i = (i + 1) & t->mask) {
+		int v = t->slots[i].load(std::memory_order_relaxed);
+		if (v == EMPTY)
+			return false;
+		if (v == item) {
+			t->slots[i].store(DELETED, std::memory_order_release);
+			s.tombstones++;
+			s.count.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+}
+
+int concurrent_hash_bag::size() const {
+	int total = 0;
+	for (int i = 0; i < SHARDS; i++)
+		total += shards[i].count.load(std::memory_order_relaxed);
+	return total;
+}
+
+// Two steps free everything retired before the call, unless a reader
+// still holds it.
+void concurrent_hash_bag::reclaim() {
+	std::lock_guard<std::mutex> guard(retire_lock);
+	if (advance_epoch())
+		advance_epoch();
+}
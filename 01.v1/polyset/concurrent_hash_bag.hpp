@@ -0,0 +1,169 @@
+#pragma once
+#include "searchable_bag.hpp"
+#include "bag_iterator.hpp"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+
+// Hash set of ints that any number of threads may read and write at once.
+//
+// The keys are split over SHARDS independent linear-probing tables by the
+// top bits of their hash. has() takes no lock: it loads the shard's table
+// pointer and probes atomic slots. Inserts lock only their own shard, and a
+// batch insert takes each shard lock once. A shard that fills up builds a
+// table twice the size under its lock and publishes it with one pointer
+// store, so readers and the other shards carry on while it does.
+//
+// A replaced table may still be in use by a reader, so it is freed by
+// epochs. Every lock-free read pins the bag's epoch for its duration,
+// counting itself in one of READER_SLOTS padded counters. Retiring a table
+// moves the epoch on once no reader is left from the epoch before, and
+// frees what was retired two epochs back. Only tables retired while a
+// reader was in flight are kept, so memory follows the current tables
+// whether the bag grows or churns. The pin costs a lookup two atomic
+// read-modify-writes, which also keep consecutive lookups from overlapping
+// their cache misses; has_batch() pins once for the whole batch.
+//
+// clear() and reclaim() are safe under concurrent use; assignment and
+// destruction are not. print() and collect() lock one shard at a time and
+// see any insert that completed before they reached its shard.
+//
+// Iterators take no lock either. An iterator pins the epoch until it is
+// destroyed, and each shard's table is loaded once, when the walk reaches
+// it: every key present for the whole walk is seen exactly once. A key
+// inserted or erased during the walk may be missed, and one erased and
+// inserted again may be seen twice. A live iterator holds back the freeing
+// of every table retired after it was created.
+//
+// erase() locks the shard and overwrites the key with DELETED, and an
+// insert fills the first tombstone on its probe chain. Within a table a
+// slot never becomes EMPTY again, so a key that stays put is always found
+// past whatever the slots in front of it hold; a reader can only miss a key
+// erased and inserted again while it looks, and either answer is right for
+// such a key. Tombstones count toward the load, and the rebuild they
+// trigger, sized for the live keys, leaves them behind.
+class concurrent_hash_bag : public searchable_bag {
+
+	private:
+	static const int SHARD_BITS = 6;
+	static const int SHARDS = 1 << SHARD_BITS;
+	static const size_t MIN_SLOTS = 16;
+	static const int READER_SLOTS = 16;
+	static const int EMPTY = -2147483647 - 1;	// marks a free slot
+	static const int DELETED = -2147483647;	// marks an erased key
+
+	struct table {
+		std::atomic<int> *slots;
+		size_t mask;	// slot count - 1, the count is a power of two
+		table *retired;	// the next table waiting to be freed
+	};
+
+	// Padded so that the hot fields of two shards never share a cache line.
+	struct shard {
+		std::atomic<table *> current;
+		std::atomic<int> count;
+		std::atomic<bool> holds_empty;	// EMPTY itself is in the set
+		std::atomic<bool> holds_deleted;	// and DELETED itself
+		int tombstones;	// DELETED slots of current, under lock
+		mutable std::mutex lock;
+		char padding[64];
+	};
+
+	// Readers inside, by the parity of the epoch they entered in. Threads
+	// share the slots round-robin.
+	struct reader_slot {
+		std::atomic<long> pins[2];
+		char padding[64];
+	};
+
+	shard shards[SHARDS];
+	mutable reader_slot readers[READER_SLOTS];
+	std::atomic<unsigned> epoch;
+	std::mutex retire_lock;
+	table *limbo[2];	// retired in an epoch of each parity, under retire_lock
+
+	// Holds the epoch a read entered in; tables retired from then on are
+	// not freed while it lives. A copy holds its own pin.
+	class pin {
+		const concurrent_hash_bag *bag;
+		int slot;
+		int parity;
+		public:
+		pin() : bag(nullptr), slot(0), parity(0) {}
+		explicit pin(const concurrent_hash_bag *b);
+		pin(const pin &other);
+		pin &operator=(const pin &other);
+		~pin();
+	};
+
+	static uint64_t hash(int item);
+	static int shard_of(uint64_t h);
+	static table *new_table(size_t slot_count);
+	static void free_tables(table *t);
+	static bool find_in(const table *t, int item, uint64_t h);
+	static bool place(table *t, int item, uint64_t h);
+	static size_t slots_for(size_t count);
+	static int reader_slot_index();
+
+	// Caller holds the lock of the shard that t belonged to.
+	void retire(table *t);
+	// Moves the epoch on if no reader is left from the one before, and
+	// frees the tables retired in that one. Caller holds retire_lock.
+	bool advance_epoch();
+
+	void init_shards();
+	static std::atomic<bool> *flag_for(shard &s, int item);
+	void grow(shard &s, size_t count);
+	bool insert_locked(shard &s, int item, uint64_t h);
+	void copy_from(const concurrent_hash_bag &other);
+
+	// stage 0 is the shard's EMPTY flag, 1 its DELETED flag, 2 slot j of
+	// t; si is SHARDS at the end. Slots are atomics, so the value is copied
+	// out. The pin keeps t and the tables after it from being freed.
+	struct cursor {
+		const concurrent_hash_bag *bag;
+		int si;
+		int stage;
+		const table *t;
+		size_t j;
+		int current;
+		pin hold;
+		const int &value() const { return current; }
+		void next();
+		// Moves on to the first value at or after the current position.
+		void settle();
+		bool operator==(const cursor &other) const {
+			return si == other.si && stage == other.stage && j == other.j;
+		}
+	};
+
+	public:
+	typedef bag_iterator<cursor, int, std::input_iterator_tag> const_iterator;
+
+	concurrent_hash_bag();
+	concurrent_hash_bag(const concurrent_hash_bag &other);
+	concurrent_hash_bag &operator=(const concurrent_hash_bag &other);
+	~concurrent_hash_bag();
+
+	void insert(int);
+	void insert(int *, int);
+	bool insert_unique(int item);
+	int insert_unique(int *items, int count);
+	void print() const;
+	void collect(std::vector<int> &out) const;
+	void clear();
+	bool has(int item) const;
+	void has_batch(const int *keys, int n, bool *out) const;
+	bool erase(int item);
+
+	// Shard by shard, in table order.
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	int size() const;
+	// Frees the retired tables that no reader still holds. Retiring a
+	// table already does this as far as the readers allow; reclaim() is for
+	// a bag that has stopped changing.
+	void reclaim();
+};
@@ -0,0 +1,222 @@
+#include "counted_hash_bag.hpp"
+#include "bag_prefetch.hpp"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+const size_t counted_hash_bag::MIN_SLOTS;
+
+// Same mix as searchable_hash_bag; the home slot comes from the low bits.
+uint64_t counted_hash_bag::hash(int item) {
+	uint64_t h = (uint64_t)(uint32_t)item * 0x9E3779B97F4A7C15ull;
+	return h ^ (h >> 32);
+}
+
+size_t counted_hash_bag::home(int item) const {
+	return (size_t)hash(item) & mask;
+}
+
+// Index of item, or of the free slot that ends its probe chain. The table
+// must be allocated.
+size_t counted_hash_bag::find(int item) const {
+	size_t i = home(item);
+	while (slots[i].count && slots[i].value != item)
+		i = (i + 1) & mask;
+	return i;
+}
+
+void counted_hash_bag::rehash(size_t slot_count) {
+	entry *old = slots;
+	size_t old_slots = old ? mask + 1 : 0;
+	slots = new entry[slot_count]();
+	mask = slot_count - 1;
+	for (size_t i = 0; i < old_slots; i++)
+		if (old[i].count)
+			slots[find(old[i].value)] = old[i];
+	delete[] old;
+}
+
+// Makes room for distinct values without passing three quarters full.
+void counted_hash_bag::grow_for(size_t distinct) {
+	size_t slot_count = slots ? mask + 1 : 0;
+	if (slots && distinct <= slot_count / 4 * 3)
+		return;
+	size_t wanted = std::max(slot_count, MIN_SLOTS);
+	while (distinct > wanted / 4 * 3)
+		wanted *= 2;
+	rehash(wanted);
+}
+
+counted_hash_bag::counted_hash_bag() : slots(nullptr), mask(0), distinct_count(0), total(0) {}
+
+counted_hash_bag::counted_hash_bag(const counted_hash_bag &other)
+	: slots(nullptr), mask(other.mask), distinct_count(other.distinct_count), total(other.total) {
+	if (other.slots) {
+		slots = new entry[mask + 1];
+		std::copy(other.slots, other.slots + mask + 1, slots);
+	}
+}
+
+counted_hash_bag::counted_hash_bag(counted_hash_bag &&other) noexcept
+	: slots(nullptr), mask(0), distinct_count(0), total(0) {
+	swap(other);
+}
+
+counted_hash_bag &counted_hash_bag::operator=(const counted_hash_bag &other) {
+	if (this != &other) {
+		counted_hash_bag copy(other);
+		swap(copy);
+	}
+	return *this;
+}
+
+counted_hash_bag &counted_hash_bag::operator=(counted_hash_bag &&other) noexcept {
+	if (this != &other) {
+		clear();
+		swap(other);
+	}
+	return *this;
+}
+
+counted_hash_bag::~counted_hash_bag() {
+	delete[] slots;
+}
+
+void counted_hash_bag::swap(counted_hash_bag &other) noexcept {
+	std::swap(slots, other.slots);
+	std::swap(mask, other.mask);
+	std::swap(distinct_count, other.distinct_count);
+	std::swap(total, other.total);
+}
+
+void counted_hash_bag::insert(int item) {
+	if (slots) {
+		size_t i = find(item);
+		if (slots[i].count) {
+			slots[i].count++;
+			total++;
+			return;
+		}
+	}
+	grow_for(distinct_count + 1);
+	size_t i = find(item);
+	slots[i].value = item;
+	slots[i].count = 1;
+	distinct_count++;
+	total++;
+}
+
+void counted_hash_bag::insert(int *items, int count) {
+	for (int i = 0; i < count; i++)
+		insert(items[i]);
+}
+
+bool counted_hash_bag::insert_unique(int item) {
+	if (has(item))
+		return false;
+	insert(item);
+	return true;
+}
+
+void counted_hash_bag::print() const {
+	std::vector<int> values;
+	collect(values);
+	for (size_t i = 0; i < values.size(); i++)
+		std::cout << values[i] << " ";
+	std::cout << std::endl;
+}
+
+void counted_hash_bag::collect(std::vector<int> &out) const {
+	if (!slots)
+		return;
+	for (size_t i = 0; i <= mask; i++)
+		out.insert(out.end(), (size_t)slots[i].count, slots[i].value);
+}
+
+void counted_hash_bag::clear() {
+	delete[] slots;
+	slots = nullptr;
+	mask = 0;
+	distinct_count = 0;
+	total = 0;
+}
+
+bool counted_hash_bag::has(int item) const {
+	return count(item) != 0;
+}
+
+// Prefetches the home slots of up to BATCH_LANES keys before probing any,
+// as searchable_hash_bag does.
+void counted_hash_bag::has_batch(const int *keys, int n, bool *out) const {
+	const int BATCH_LANES = 16;
+	if (!slots) {
+		std::fill(out, out + n, false);
+		return;
+	}
+	for (int b = 0; b < n; b += BATCH_LANES) {
+		int lanes = std::min(BATCH_LANES, n - b);
+		for (int i = 0; i < lanes; i++)
+			BAG_PREFETCH(&slots[home(keys[b + i])]);
+		for (int i = 0; i < lanes; i++)
+			out[b + i] = slots[find(keys[b + i])].count != 0;
+	}
+}
+
+counted_hash_bag::const_iterator counted_hash_bag::begin() const {
+	cursor c = { slots, 0, slots ? mask + 1 : 0, 0 };
+	c.skip_free();
+	return const_iterator(c);
+}
+
+counted_hash_bag::const_iterator counted_hash_bag::end() const {
+	size_t n = slots ? mask + 1 : 0;
+	cursor c = { slots, n, n, 0 };
+	return const_iterator(c);
+}
+
+int counted_hash_bag::count(int item) const {
+	if (!slots)
+		return 0;
+	return slots[find(item)].count;
+}
+
+// When the last copy goes, each later slot of the probe chain moves into
+// the hole if the hole lies between its home and where it sits now, and the
+// hole follows it; the chain stays unbroken without tombstones.
+bool counted_hash_bag::erase_one(int item) {
+	if (!slots)
+		return false;
+	size_t hole = find(item);
+	if (!slots[hole].count)
+		return false;
+	total--;
+	if (--slots[hole].count)
+		return true;
+	distinct_count--;
+	for (size_t j = (hole + 1) & mask; slots[j].count; j = (j + 1) & mask) {
+		size_t h = home(slots[j].value);
+		if (((j - h) & mask) >= ((j - hole) & mask)) {
+			slots[hole] = slots[j];
+			hole = j;
+		}
+	}
+	slots[hole].count = 0;
+	return true;
+}
+
+bool counted_hash_bag::erase(int item) {
+	return erase_one(item);
+}
+
+long long counted_hash_bag::size() const {
+	return total;
+}
+
+int counted_hash_bag::distinct() const {
+	return (int)distinct_count;
+}
+
+void counted_hash_bag::reserve(int distinct) {
+	if (distinct > 0)
+		grow_for((size_t)distinct);
+}
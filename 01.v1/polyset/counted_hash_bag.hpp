@@ -0,0 +1,101 @@
+#pragma once
+#include "searchable_bag.hpp"
+#include "bag_iterator.hpp"
+#include <cstddef>
+#include <stdint.h>
+
+// Multiset of ints that stores each distinct value once, with the number of
+// times it was inserted. Memory follows the number of distinct values, not
+// the number of inserts, so a stream where every value repeats a hundred
+// times costs a hundredth of an array_bag.
+//
+// A linear-probing table of (value, count) slots; a count of zero marks a
+// free slot, so every int value can be stored. The table doubles past three
+// quarters full. erase_one() removing the last copy shifts the rest of the
+// probe chain back, so lookups never meet a tombstone. print() and
+// collect() list each value as many times as it was inserted, as
+// array_bag does; insert_unique() adds a value only when its count is zero.
+//
+// A count is an int so that a slot stays eight bytes: one value may be
+// inserted at most INT_MAX times, and a further insert of it overflows its
+// count. size() sums the counts in a long long and has no such limit.
+class counted_hash_bag : public searchable_bag {
+
+	private:
+	static const size_t MIN_SLOTS = 16;
+
+	struct entry {
+		int value;
+		int count;	// 0: free slot; at most INT_MAX
+	};
+
+	entry *slots;
+	size_t mask;		// slot count - 1, the count is a power of two
+	size_t distinct_count;
+	long long total;
+
+	static uint64_t hash(int item);
+	size_t home(int item) const;
+	size_t find(int item) const;
+	void rehash(size_t slot_count);
+	void grow_for(size_t distinct);
+
+	// Stays on a slot for as many steps as its count; i is the slot count
+	// at the end.
+	struct cursor {
+		const entry *slots;
+		size_t i;
+		size_t n;
+		int copy;
+		const int &value() const { return slots[i].value; }
+		void next() {
+			if (++copy < slots[i].count)
+				return;
+			copy = 0;
+			i++;
+			skip_free();
+		}
+		void skip_free() {
+			while (i < n && !slots[i].count)
+				i++;
+		}
+		bool operator==(const cursor &other) const { return i == other.i && copy == other.copy; }
+	};
+
+	public:
+	typedef bag_iterator<cursor, int> const_iterator;
+
+	counted_hash_bag();
+	counted_hash_bag(const counted_hash_bag &other);
+	counted_hash_bag(counted_hash_bag &&other) noexcept;
+	counted_hash_bag &operator=(const counted_hash_bag &other);
+	counted_hash_bag &operator=(counted_hash_bag &&other) noexcept;
+	~counted_hash_bag();
+
+	void swap(counted_hash_bag &other) noexcept;
+
+	void insert(int);
+	void insert(int *, int);
+	using searchable_bag::insert_unique;
+	bool insert_unique(int item);
+	void print() const;
+	void collect(std::vector<int> &out) const;
+	void clear();
+	bool has(int item) const;
+	void has_batch(const int *keys, int n, bool *out) const;
+	// Same as erase_one().
+	bool erase(int item);
+
+	// Every copy, as collect() lists them.
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	// Number of copies of item.
+	int count(int item) const;
+	// Removes one copy of item; false when there was none.
+	bool erase_one(int item);
+	// Inserts, counting copies, not distinct values.
+	long long size() const;
+	int distinct() const;
+	void reserve(int distinct);
+};
@@ -0,0 +1,259 @@
+#include "frozen_bag.hpp"
+#include "bag_prefetch.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <utility>
+
+static inline int trailing_ones(size_t k) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(~(unsigned long long)k);
+#else
+	int n = 0;
+	for (; k & 1; k >>= 1)
+		n++;
+	return n;
+#endif
+}
+
+// In-order walk over the implicit tree 1..n: the first slot is the
+// leftmost descent from the root, and the walk ends at 0.
+static size_t first_in_order(size_t n) {
+	if (n == 0)
+		return 0;
+	size_t k = 1;
+	while (2 * k <= n)
+		k *= 2;
+	return k;
+}
+
+static size_t next_in_order(size_t k, size_t n) {
+	if (2 * k + 1 <= n) {
+		k = 2 * k + 1;
+		while (2 * k <= n)
+			k *= 2;
+		return k;
+	}
+	return k >> (trailing_ones(k) + 1);
+}
+
+static int *align_keys(int *storage) {
+	uintptr_t p = reinterpret_cast<uintptr_t>(storage);
+	return reinterpret_cast<int *>((p + 63) & ~(uintptr_t)63);
+}
+
+frozen_bag::frozen_bag() : storage(nullptr), keys(nullptr), count(0), dead_count(0) {}
+
+frozen_bag::frozen_bag(const bag &source) : storage(nullptr), keys(nullptr), count(0), dead_count(0) {
+	std::vector<int> values;
+	source.collect(values);
+	build(values);
+}
+
+frozen_bag::frozen_bag(const int *items, int n) : storage(nullptr), keys(nullptr), count(0), dead_count(0) {
+	std::vector<int> values(items, items + std::max(n, 0));
+	build(values);
+}
+
+frozen_bag::frozen_bag(const frozen_bag &other) : storage(nullptr), keys(nullptr), count(0), dead_count(0) {
+	std::vector<int> values;
+	other.collect(values);
+	build(values);
+}
+
+frozen_bag::frozen_bag(frozen_bag &&other) noexcept : storage(nullptr), keys(nullptr), count(0), dead_count(0) {
+	swap(other);
+}
+
+frozen_bag &frozen_bag::operator=(const frozen_bag &other) {
+	if (this != &other) {
+		std::vector<int> values;
+		other.collect(values);
+		build(values);
+	}
+	return *this;
+}
+
+frozen_bag &frozen_bag::operator=(frozen_bag &&other) noexcept {
+	if (this != &other) {
+		clear();
+		swap(other);
+	}
+	return *this;
+}
+
+frozen_bag::~frozen_bag() {
+	delete[] storage;
+	storage = nullptr;
+	keys = nullptr;
+}
+
+void frozen_bag::swap(frozen_bag &other) noexcept {
+	std::swap(storage, other.storage);
+	std::swap(keys, other.keys);
+	std::swap(count, other.count);
+	dead.swap(other.dead);
+	std::swap(dead_count, other.dead_count);
+}
+
+// Sorts and deduplicates values, then writes them to the slots in in-order
+// sequence, which places every key at its Eytzinger position.
+void frozen_bag::build(std::vector<int> &values) {
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+
+	delete[] storage;
+	storage = nullptr;
+	keys = nullptr;
+	dead.clear();
+	dead_count = 0;
+	count = (int)values.size();
+	if (count == 0)
+		return;
+	storage = new int[count + 1 + 16];
+	keys = align_keys(storage);
+	size_t k = first_in_order(count);
+	for (int i = 0; i < count; i++) {
+		keys[k] = values[i];
+		k = next_in_order(k, count);
+	}
+}
+
+void frozen_bag::insert(int item) {
+	insert(&item, 1);
+}
+
+void frozen_bag::insert(int *items, int n) {
+	if (n <= 0)
+		return;
+	std::vector<int> values;
+	values.reserve(count + n);
+	collect(values);
+	values.insert(values.end(), items, items + n);
+	build(values);
+}
+
+bool frozen_bag::insert_unique(int item) {
+	if (has(item))
+		return false;
+	insert(&item, 1);
+	return true;
+}
+
+int frozen_bag::insert_unique(int *items, int n) {
+	int before = size();
+	insert(items, n);
+	return size() - before;
+}
+
+void frozen_bag::print() const {
+	for (size_t k = first_in_order(count); k; k = next_in_order(k, count))
+		if (dead.empty() || !dead[k])
+			std::cout << keys[k] << " ";
+	std::cout << std::endl;
+}
+
+void frozen_bag::collect(std::vector<int> &out) const {
+	for (size_t k = first_in_order(count); k; k = next_in_order(k, count))
+		if (dead.empty() || !dead[k])
+			out.push_back(keys[k]);
+}
+
+void frozen_bag::cursor::next() {
+	k = next_in_order(k, n);
+	skip_dead();
+}
+
+void frozen_bag::cursor::skip_dead() {
+	while (k && dead && dead[k])
+		k = next_in_order(k, n);
+}
+
+frozen_bag::const_iterator frozen_bag::begin() const {
+	cursor c = { keys, dead.empty() ? nullptr : dead.data(), first_in_order(count), (size_t)count };
+	c.skip_dead();
+	return const_iterator(c);
+}
+
+frozen_bag::const_iterator frozen_bag::end() const {
+	cursor c = { keys, nullptr, 0, (size_t)count };
+	return const_iterator(c);
+}
+
+void frozen_bag::clear() {
+	delete[] storage;
+	storage = nullptr;
+	keys = nullptr;
+	count = 0;
+	dead.clear();
+	dead_count = 0;
+}
+
+// Descends with k = 2k + (keys[k] < item) until k leaves the array; the
+// lower bound is then k with its trailing right turns and the final left
+// turn shifted off. The line holding slot 16k, four levels below, is
+// requested on every step; the address is formed as an integer because it
+// may lie past the array.
+bool frozen_bag::has(int item) const {
+	size_t n = count;
+	size_t k = 1;
+	while (k <= n) {
+		BAG_PREFETCH(reinterpret_cast<const void *>(reinterpret_cast<uintptr_t>(keys) + 64 * k));
+		k = 2 * k + (keys[k] < item);
+	}
+	k >>= trailing_ones(k) + 1;
+	return k != 0 && keys[k] == item && (dead.empty() || !dead[k]);
+}
+
+// The has() descent for up to BATCH_LANES keys in lockstep. Lanes finish
+// within one level of each other; a finished lane just sits out the round.
+void frozen_bag::has_batch(const int *items, int n, bool *out) const {
+	const int BATCH_LANES = 16;
+	size_t total = count;
+	for (int base = 0; base < n; base += BATCH_LANES) {
+		int lanes = std::min(BATCH_LANES, n - base);
+		size_t k[BATCH_LANES];
+		for (int i = 0; i < lanes; i++)
+			k[i] = 1;
+		for (bool active = total > 0; active; ) {
+			active = false;
+			for (int i = 0; i < lanes; i++) {
+				if (k[i] > total)
+					continue;
+				BAG_PREFETCH(reinterpret_cast<const void *>(reinterpret_cast<uintptr_t>(keys) + 64 * k[i]));
+				k[i] = 2 * k[i] + (keys[k[i]] < items[base + i]);
+				active = true;
+			}
+		}
+		for (int i = 0; i < lanes; i++) {
+			size_t j = k[i] >> (trailing_ones(k[i]) + 1);
+			out[base + i] = j != 0 && keys[j] == items[base + i] && (dead.empty() || !dead[j]);
+		}
+	}
+}
+
+// The same descent as has(); the layout is only rebuilt once enough slots
+// are dead to pay for it.
+bool frozen_bag::erase(int item) {
+	size_t n = count;
+	size_t k = 1;
+	while (k <= n)
+		k = 2 * k + (keys[k] < item);
+	k >>= trailing_ones(k) + 1;
+	if (k == 0 || keys[k] != item || (!dead.empty() && dead[k]))
+		return false;
+	if (dead.empty())
+		dead.assign(n + 1, 0);
+	dead[k] = 1;
+	dead_count++;
+	if (4 * dead_count >= count) {
+		std::vector<int> values;
+		collect(values);
+		build(values);
+	}
+	return true;
+}
+
+int frozen_bag::size() const {
+	return count - dead_count;
+}
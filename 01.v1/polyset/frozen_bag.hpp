@@ -0,0 +1,70 @@
+#pragma once
+#include "searchable_bag.hpp"
+#include "bag_iterator.hpp"
+#include <cstddef>
+#include <vector>
+
+// Read-mostly set of ints stored in Eytzinger (breadth-first) order: the
+// children of slot k are 2k and 2k+1, so a search walks one array from the
+// front and the sixteen descendants four levels down share one cache line,
+// which is prefetched at every step. The loop has no data-dependent branch.
+//
+// Built once from another bag or from an array; duplicates are dropped.
+// insert() rebuilds the whole layout and is meant for occasional top-ups,
+// not for building the set one key at a time. erase() only flags the slot
+// dead; a rebuild drops the dead keys, and erase() forces one once a
+// quarter of the slots are dead.
+class frozen_bag : public searchable_bag {
+
+	private:
+	int *storage;	// allocation, over-sized so that keys can be aligned
+	int *keys;	// keys[1..count] in Eytzinger order, 64-byte aligned
+	int count;	// slots, dead ones included
+	std::vector<unsigned char> dead;	// per slot, or empty when none is dead
+	int dead_count;
+
+	void build(std::vector<int> &values);
+
+	// Walks the slots in order, which is sorted order; k is 0 at the end.
+	struct cursor {
+		const int *keys;
+		const unsigned char *dead;	// nullptr when no slot is dead
+		size_t k;
+		size_t n;
+		const int &value() const { return keys[k]; }
+		void next();
+		void skip_dead();
+		bool operator==(const cursor &other) const { return k == other.k; }
+	};
+
+	public:
+	typedef bag_iterator<cursor, int> const_iterator;
+
+	frozen_bag();
+	explicit frozen_bag(const bag &source);
+	frozen_bag(const int *items, int n);
+	frozen_bag(const frozen_bag &other);
+	frozen_bag(frozen_bag &&other) noexcept;
+	frozen_bag &operator=(const frozen_bag &other);
+	frozen_bag &operator=(frozen_bag &&other) noexcept;
+	~frozen_bag();
+
+	void swap(frozen_bag &other) noexcept;
+
+	void insert(int);
+	void insert(int *, int);
+	bool insert_unique(int item);
+	int insert_unique(int *items, int n);
+	void print() const;
+	void collect(std::vector<int> &out) const;
+	void clear();
+	bool has(int item) const;
+	void has_batch(const int *items, int n, bool *out) const;
+	bool erase(int item);
+
+	// The live keys in sorted order.
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	int size() const;
+};
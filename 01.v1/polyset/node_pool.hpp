@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <new>
+#include <type_traits>
+
+// Slab allocator for the fixed-size nodes of one tree bag.
+//
+// Nodes are carved out of contiguous chunks whose size doubles up to
+// MAX_CHUNK, recycled through an intrusive free list on deallocate(), and
+// all returned to the heap at once by release(). T must be trivially
+// destructible: release() does not run destructors. Chunks come from Alloc,
+// rebound to the slot type.
+template <typename T, typename Alloc = std::allocator<T> >
+class node_pool {
+	private:
+		union slot {
+			slot *next;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+		};
+		typedef typename std::allocator_traits<Alloc>::template rebind_alloc<slot> slot_alloc;
+		typedef std::allocator_traits<slot_alloc> slot_traits;
+
+		static const std::size_t MIN_CHUNK = 64;
+		static const std::size_t MAX_CHUNK = 65536;
+
+		// Slot 0 of every chunk links to the previous chunk, and slot 1
+		// holds its size in slots.
+		slot *chunks;
+		slot *free_list;
+		slot *bump;
+		slot *bump_end;
+		std::size_t next_chunk;
+		slot_alloc alloc;
+
+		void add_chunk(std::size_t count) {
+			// Keep the unused tail of the current chunk reachable.
+			while (bump != bump_end) {
+				bump->next = free_list;
+				free_list = bump++;
+			}
+			slot *chunk = slot_traits::allocate(alloc, count + 2);
+			chunk[0].next = chunks;
+			*reinterpret_cast<std::size_t *>(&chunk[1].storage) = count + 2;
+			chunks = chunk;
+			bump = chunk + 2;
+			bump_end = chunk + 2 + count;
+		}
+
+		node_pool(const node_pool &);
+		node_pool &operator=(const node_pool &);
+
+	public:
+		explicit node_pool(const Alloc &a = Alloc()) : chunks(nullptr), free_list(nullptr),
+			bump(nullptr), bump_end(nullptr), next_chunk(MIN_CHUNK), alloc(a) {}
+		~node_pool() { release(); }
+
+		T *allocate() {
+			slot *s;
+			if (free_list) {
+				s = free_list;
+				free_list = s->next;
+			} else {
+				if (bump == bump_end) {
+					add_chunk(next_chunk);
+					if (next_chunk < MAX_CHUNK)
+						next_chunk *= 2;
+				}
+				s = bump++;
+			}
+			return new (&s->storage) T;
+		}
+
+		void deallocate(T *p) {
+			slot *s = reinterpret_cast<slot *>(p);
+			s->next = free_list;
+			free_list = s;
+		}
+
+		// Guarantees that the next count allocations come from one chunk
+		// (or from the free list) without further heap calls.
+		void reserve(std::size_t count) {
+			if (count > static_cast<std::size_t>(bump_end - bump))
+				add_chunk(count);
+		}
+
+		// Frees every chunk; all nodes handed out become invalid.
+		void release() {
+			while (chunks) {
+				slot *prev = chunks[0].next;
+				slot_traits::deallocate(alloc, chunks,
+					*reinterpret_cast<std::size_t *>(&chunks[1].storage));
+				chunks = prev;
+			}
+			free_list = nullptr;
+			bump = nullptr;
+			bump_end = nullptr;
+			next_chunk = MIN_CHUNK;
+		}
+
+		void swap(node_pool &other) noexcept {
+			std::swap(chunks, other.chunks);
+			std::swap(free_list, other.free_list);
+			std::swap(bump, other.bump);
+			std::swap(bump_end, other.bump_end);
+			std::swap(next_chunk, other.next_chunk);
+			std::swap(alloc, other.alloc);
+		}
+};
@@ -0,0 +1,573 @@
+// Benchmark driver for the bag hierarchy.
+//
+//   g++ -O2 -std=c++11 -pthread *_bag.cpp set.cpp polyset_bench_main.cpp -o polyset_bench
+//   ./polyset_bench [n]
+//
+// Every bag is built from sorted keys and from shuffled keys one insert at
+// a time, and from the shuffled keys with one bulk insert; each build is
+// followed by n random lookups (about half hit), and the bulk build also by
+// the same lookups through has_batch() and then by inserting the lookup keys
+// with insert_unique(int *, int). Results are printed as
+// JSON, one object per line, in ns per operation; bytes_per_key is the heap
+// the bag holds after the build, counted by the replaced operator new.
+//
+// concurrent_hash_bag is then run from 1 to MAX_THREADS threads against a
+// searchable_hash_bag behind one mutex: the threads split n inserts, then n
+// lookups, then n mixed operations (one insert of a new key per nine
+// lookups). For these, ns_per_op is wall time over all threads' operations,
+// so linear scaling halves it with every doubling of "threads"; it can only
+// do so up to the number of hardware threads.
+//
+// The churn workload fills each bag with half the keys, then runs n
+// operations: one insert of a new key and one erase of a stored key for
+// every two lookups, so the size holds steady while tombstones, rebuilds
+// and rebalancing pile up.
+//
+// A stream of n inserts over n / DUP_RATIO distinct values compares the
+// counted multiset with array_bag, which keeps every copy; bytes_per_key is
+// per insert.
+//
+// tree_bag is run with its tracing policy off (null_trace, the default)
+// and on (ring_trace), over n random inserts, n inserts of the lookup keys
+// and n / 2 erases.
+//
+// Last, each static bag is driven through static_set and, wrapped in
+// virtual_bag, through set: n inserts, n lookups, and n lookups into a bag
+// of SMALL_N keys that stays in L1, where the call itself dominates. The
+// "virtual" and "static" pairs differ only in the dispatch.
+//
+// Bags with a linear operation on the measured path are capped: unbalanced
+// tree_bag degenerates on sorted input, array_bag::has and single inserts
+// into a sorted array are linear, and every frozen_bag insert rebuilds the
+// whole layout. Their "n" field shows the size used.
+
+#include "searchable_bag.hpp"
+#include "searchable_array_bag.hpp"
+#include "searchable_tree_bag.hpp"
+#include "searchable_balanced_tree_bag.hpp"
+#include "searchable_sorted_array_bag.hpp"
+#include "searchable_hash_bag.hpp"
+#include "searchable_bitmap_bag.hpp"
+#include "searchable_btree_bag.hpp"
+#include "frozen_bag.hpp"
+#include "concurrent_hash_bag.hpp"
+#include "counted_hash_bag.hpp"
+#include "static_hash_bag.hpp"
+#include "static_sorted_array_bag.hpp"
+#include "static_set.hpp"
+#include "virtual_bag.hpp"
+#include "set.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int LINEAR_LIMIT = 20000;
+static const int REBUILD_LIMIT = 1000;
+static const int MAX_THREADS = 16;
+static const int SMALL_N = 1024;
+static const int DUP_RATIO = 100;
+
+// Every allocation carries a 16-byte header with its size so the live total
+// can be kept without asking the C library. Kept out of line: once inlined
+// into container code, GCC takes the header arithmetic for a bad free.
+static std::atomic<size_t> live_bytes(0);
+
+#if defined(__GNUC__)
+# define BENCH_NOINLINE __attribute__((noinline))
+#else
+# define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void *operator new(std::size_t n) {
+	void *p = std::malloc(n + 16);
+	if (!p)
+		throw std::bad_alloc();
+	*static_cast<std::size_t *>(p) = n;
+	live_bytes.fetch_add(n, std::memory_order_relaxed);
+	return static_cast<char *>(p) + 16;
+}
+
+BENCH_NOINLINE void operator delete(void *p) noexcept {
+	if (!p)
+		return;
+	char *block = static_cast<char *>(p) - 16;
+	live_bytes.fetch_sub(*reinterpret_cast<std::size_t *>(block), std::memory_order_relaxed);
+	std::free(block);
+}
+
+// C++14 calls this form when the size is known; the header already has it.
+void operator delete(void *p, std::size_t) noexcept {
+	::operator delete(p);
+}
+
+struct bench_input {
+	std::vector<int> sorted;
+	std::vector<int> shuffled;
+	std::vector<int> queries;
+};
+
+struct bench_result {
+	std::string bag;
+	std::string workload;
+	int n;
+	double ns_per_op;
+	double bytes_per_key;
+	int threads;
+};
+
+// The baseline the concurrent bag replaces: every operation takes one lock.
+class locked_hash_bag {
+	private:
+		std::mutex lock;
+		searchable_hash_bag bag;
+	public:
+		void insert(int item) {
+			std::lock_guard<std::mutex> guard(lock);
+			bag.insert(item);
+		}
+		bool has(int item) {
+			std::lock_guard<std::mutex> guard(lock);
+			return bag.has(item);
+		}
+};
+
+template <typename F>
+static double time_ns(F body) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	body();
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static volatile bool sink;
+
+template <typename Bag>
+static void bench_has(const std::string &name, const std::string &workload, Bag &bag,
+		int n, double bytes_per_key, const std::vector<int> &queries, std::vector<bench_result> &results) {
+	bool found = false;
+	double ns = time_ns([&]() {
+		for (size_t i = 0; i < queries.size(); i++)
+			found ^= bag.has(queries[i]);
+	});
+	sink = sink ^ found;
+	bench_result r = { name, workload, n, ns / queries.size(), bytes_per_key, 1 };
+	results.push_back(r);
+}
+
+template <typename Bag>
+static void bench_has_batch(const std::string &name, const std::string &workload, Bag &bag,
+		int n, double bytes_per_key, const std::vector<int> &queries, std::vector<bench_result> &results) {
+	bool *out = new bool[queries.size()];
+	double ns = time_ns([&]() {
+		bag.has_batch(queries.data(), (int)queries.size(), out);
+	});
+	bool found = false;
+	for (size_t i = 0; i < queries.size(); i++)
+		found ^= out[i];
+	sink = sink ^ found;
+	delete[] out;
+	bench_result r = { name, workload, n, ns / queries.size(), bytes_per_key, 1 };
+	results.push_back(r);
+}
+
+// single_limit caps the one-at-a-time builds, bulk_limit the bulk build and
+// every lookup pass.
+template <typename Bag>
+static void bench_bag(const std::string &name, int single_limit, int bulk_limit,
+		const bench_input &in, std::vector<bench_result> &results) {
+	int n = (int)in.sorted.size();
+	int single_n = std::min(n, single_limit);
+	int bulk_n = std::min(n, bulk_limit);
+	std::vector<int> queries(in.queries.begin(), in.queries.begin() + bulk_n);
+
+	std::vector<int> sorted(in.sorted.begin(), in.sorted.begin() + single_n);
+	std::vector<int> shuffled(in.shuffled.begin(), in.shuffled.begin() + single_n);
+	const char *workloads[] = { "sorted", "random" };
+	const std::vector<int> *inputs[] = { &sorted, &shuffled };
+
+	for (int w = 0; w < 2; w++) {
+		std::vector<int> single_queries(queries.begin(), queries.begin() + std::min(bulk_n, single_n));
+		Bag bag;
+		const std::vector<int> &input = *inputs[w];
+		size_t before = live_bytes;
+		double ns = time_ns([&]() {
+			for (size_t i = 0; i < input.size(); i++)
+				bag.insert(input[i]);
+		});
+		double bytes = (double)(live_bytes - before) / single_n;
+		bench_result r = { name, std::string("insert_") + workloads[w], single_n, ns / single_n, bytes, 1 };
+		results.push_back(r);
+		bench_has(name, std::string("has_after_") + workloads[w], bag, single_n, bytes,
+			single_queries, results);
+	}
+
+	Bag bag;
+	std::vector<int> bulk(in.shuffled.begin(), in.shuffled.begin() + bulk_n);
+	size_t before = live_bytes;
+	double ns = time_ns([&]() {
+		bag.insert(bulk.data(), bulk_n);
+	});
+	double bytes = (double)(live_bytes - before) / bulk_n;
+	bench_result r = { name, "insert_bulk", bulk_n, ns / bulk_n, bytes, 1 };
+	results.push_back(r);
+	bench_has(name, "has_after_bulk", bag, bulk_n, bytes, queries, results);
+	bench_has_batch(name, "has_batch_after_bulk", bag, bulk_n, bytes, queries, results);
+
+	ns = time_ns([&]() {
+		bag.insert_unique(queries.data(), bulk_n);
+	});
+	bench_result u = { name, "insert_unique_after_bulk", bulk_n, ns / bulk_n,
+		(double)(live_bytes - before) / bulk_n, 1 };
+	results.push_back(u);
+}
+
+// Runs body(t, begin, end) on threads 0..threads-1, each over its share of
+// [0, n), and returns the wall time.
+template <typename F>
+static double time_threads(int threads, int n, F body) {
+	std::vector<std::thread> pool;
+	return time_ns([&]() {
+		for (int t = 0; t < threads; t++)
+			pool.push_back(std::thread(body, t, (int)((long long)n * t / threads),
+				(int)((long long)n * (t + 1) / threads)));
+		for (size_t t = 0; t < pool.size(); t++)
+			pool[t].join();
+	});
+}
+
+template <typename Bag>
+static void bench_threads(const std::string &name, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = (int)in.sorted.size();
+	for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		Bag bag;
+		std::atomic<bool> found(false);
+		size_t before = live_bytes;
+		double ns = time_threads(threads, n, [&](int, int begin, int end) {
+			for (int i = begin; i < end; i++)
+				bag.insert(in.shuffled[i]);
+		});
+		double bytes = (double)(live_bytes - before) / n;
+		bench_result r = { name, "mt_insert", n, ns / n, bytes, threads };
+		results.push_back(r);
+
+		ns = time_threads(threads, n, [&](int, int begin, int end) {
+			bool f = false;
+			for (int i = begin; i < end; i++)
+				f ^= bag.has(in.queries[i]);
+			found = found ^ f;
+		});
+		bench_result h = { name, "mt_has", n, ns / n, bytes, threads };
+		results.push_back(h);
+
+		// The inserted keys are odd, so they are all new.
+		ns = time_threads(threads, n, [&](int, int begin, int end) {
+			bool f = false;
+			for (int i = begin; i < end; i++) {
+				if (i % 10 == 0)
+					bag.insert(in.queries[i] | 1);
+				else
+					f ^= bag.has(in.queries[i]);
+			}
+			found = found ^ f;
+		});
+		bench_result m = { name, "mt_mixed", n, ns / n, bytes, threads };
+		results.push_back(m);
+		sink = sink ^ found;
+	}
+}
+
+template <typename Bag>
+static void bench_churn(const std::string &name, int limit, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = std::min((int)in.shuffled.size(), limit);
+	int half = n / 2;
+	Bag bag;
+	std::vector<int> initial(in.shuffled.begin(), in.shuffled.begin() + half);
+	bag.insert(initial.data(), half);
+	size_t before = live_bytes;
+	bool found = false;
+	int next_insert = half;
+	int next_erase = 0;
+	double ns = time_ns([&]() {
+		for (int i = 0; i < n; i++) {
+			switch (i & 3) {
+				case 0:
+					bag.insert(in.shuffled[next_insert++ % n]);
+					break;
+				case 1:
+					found ^= bag.erase(in.shuffled[next_erase++ % n]);
+					break;
+				default:
+					found ^= bag.has(in.queries[i]);
+			}
+		}
+	});
+	sink = sink ^ found;
+	bench_result r = { name, "mixed_churn", n, ns / n,
+		(double)(live_bytes - before) / std::max(half, 1), 1 };
+	results.push_back(r);
+}
+
+template <typename Bag>
+static void bench_duplicates(const std::string &name, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = (int)in.shuffled.size();
+	int distinct = std::max(1, n / DUP_RATIO);
+	std::vector<int> stream(n);
+	for (int i = 0; i < n; i++)
+		stream[i] = in.shuffled[i] % (2 * distinct);
+	Bag bag;
+	size_t before = live_bytes;
+	double ns = time_ns([&]() {
+		for (int i = 0; i < n; i++)
+			bag.insert(stream[i]);
+	});
+	bench_result r = { name, "insert_dup" + std::to_string(DUP_RATIO), n, ns / n,
+		(double)(live_bytes - before) / n, 1 };
+	results.push_back(r);
+}
+
+// Reads every key once through the iterators and once through collect(),
+// which copies them into a vector first.
+template <typename Bag>
+static void bench_iterate(const std::string &name, int limit, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = std::min((int)in.shuffled.size(), limit);
+	std::vector<int> keys(in.shuffled.begin(), in.shuffled.begin() + n);
+	Bag bag;
+	bag.insert(keys.data(), n);
+	long long total = 0;
+	size_t before = live_bytes;
+	double ns = time_ns([&]() {
+		for (int v : bag)
+			total += v;
+	});
+	bench_result r = { name, "iterate", n, ns / n, (double)(live_bytes - before) / n, 1 };
+	results.push_back(r);
+	ns = time_ns([&]() {
+		std::vector<int> out;
+		bag.collect(out);
+		for (size_t i = 0; i < out.size(); i++)
+			total += out[i];
+	});
+	// collect() holds a copy of every key while it runs.
+	bench_result c = { name, "collect", n, ns / n, (double)sizeof(int), 1 };
+	results.push_back(c);
+	sink = sink ^ (total & 1);
+}
+
+// rank, select and count_range over all n keys after an eighth of them were
+// erased, so tombstoned and emptied slots are on the query paths too.
+template <typename Bag>
+static void bench_order(const std::string &name, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = (int)in.shuffled.size();
+	std::vector<int> keys(in.shuffled);
+	size_t before = live_bytes;
+	Bag bag;
+	bag.insert(keys.data(), n);
+	for (int i = 0; i < n; i += 8)
+		bag.erase(in.shuffled[i]);
+	double bytes = (double)(live_bytes - before) / n;
+	int live = n - (n + 7) / 8;
+	long long total = 0;
+	double ns = time_ns([&]() {
+		for (int i = 0; i < n; i++)
+			total += bag.rank(in.queries[i]);
+	});
+	bench_result r = { name, "rank", n, ns / n, bytes, 1 };
+	results.push_back(r);
+	ns = time_ns([&]() {
+		for (int i = 0; i < n; i++) {
+			int value = 0;
+			bag.select(in.queries[i] % live, value);
+			total += value;
+		}
+	});
+	bench_result s = { name, "select", n, ns / n, bytes, 1 };
+	results.push_back(s);
+	ns = time_ns([&]() {
+		for (int i = 0; i < n; i++)
+			total += bag.count_range(in.queries[i], in.queries[i] + n / 100);
+	});
+	bench_result c = { name, "count_range", n, ns / n, bytes, 1 };
+	results.push_back(c);
+	sink = sink ^ (total & 1);
+}
+
+template <typename Set>
+static void time_set(Set &s, const std::vector<int> &keys, const std::vector<int> &queries,
+		double &insert_ns, double &has_ns) {
+	insert_ns = time_ns([&]() {
+		for (size_t i = 0; i < keys.size(); i++)
+			s.insert(keys[i]);
+	});
+	bool found = false;
+	has_ns = time_ns([&]() {
+		for (size_t i = 0; i < queries.size(); i++)
+			found ^= s.has(queries[i]);
+	});
+	sink = sink ^ found;
+}
+
+// The virtual bag is read back through a volatile pointer so the compiler
+// cannot see its dynamic type, as it could not in code handed a
+// searchable_bag &. limit caps the size of the large bag.
+template <typename Bag>
+static void bench_dispatch(const std::string &name, int limit, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = std::min((int)in.sorted.size(), limit);
+	int small_n = std::min(n, SMALL_N);
+	std::vector<int> small_keys(in.shuffled.begin(), in.shuffled.begin() + small_n);
+	std::vector<int> large_queries(in.queries.begin(), in.queries.begin() + n);
+	std::vector<int> small_queries(n);
+	for (size_t i = 0; i < small_queries.size(); i++)
+		small_queries[i] = small_keys[i % small_n] + (int)(i & 1);
+
+	const int sizes[] = { n, small_n };
+	const char *prefixes[] = { "", "small_" };
+	for (int k = 0; k < 2; k++) {
+		std::vector<int> keys(in.shuffled.begin(), in.shuffled.begin() + sizes[k]);
+		const std::vector<int> &queries = k ? small_queries : large_queries;
+		double insert_ns[2];
+		double has_ns[2];
+		double bytes[2];
+
+		size_t before = live_bytes;
+		virtual_bag<Bag> erased;
+		searchable_bag *volatile hidden = &erased;
+		set virtual_set(*hidden);
+		time_set(virtual_set, keys, queries, insert_ns[0], has_ns[0]);
+		bytes[0] = (double)(live_bytes - before) / sizes[k];
+
+		before = live_bytes;
+		Bag bag;
+		static_set<Bag> direct(bag);
+		time_set(direct, keys, queries, insert_ns[1], has_ns[1]);
+		bytes[1] = (double)(live_bytes - before) / sizes[k];
+
+		const char *kinds[] = { "virtual", "static" };
+		for (int d = 0; d < 2; d++) {
+			bench_result i = { name, std::string("insert_") + prefixes[k] + kinds[d], sizes[k],
+				insert_ns[d] / sizes[k], bytes[d], 1 };
+			bench_result h = { name, std::string("has_") + prefixes[k] + kinds[d], sizes[k],
+				has_ns[d] / queries.size(), bytes[d], 1 };
+			results.push_back(i);
+			results.push_back(h);
+		}
+	}
+}
+
+// The same tree_bag with tracing compiled out and with a ring_trace: n
+// inserts of shuffled keys, n inserts of the lookup keys (about half of
+// them duplicates), then erasing the first half of the keys.
+template <typename Trace>
+static void bench_trace(const std::string &name, const bench_input &in,
+		std::vector<bench_result> &results) {
+	int n = (int)in.shuffled.size();
+	int half = n / 2;
+	basic_searchable_tree_bag<int, std::less<int>, std::allocator<int>, Trace> bag;
+	size_t before = live_bytes;
+	double ns = time_ns([&]() {
+		for (int i = 0; i < n; i++)
+			bag.insert(in.shuffled[i]);
+	});
+	double bytes = (double)(live_bytes - before) / n;
+	bench_result r = { name, "insert_random", n, ns / n, bytes, 1 };
+	results.push_back(r);
+	ns = time_ns([&]() {
+		for (int i = 0; i < n; i++)
+			bag.insert(in.queries[i]);
+	});
+	bench_result d = { name, "insert_queries", n, ns / n, bytes, 1 };
+	results.push_back(d);
+	bool found = false;
+	ns = time_ns([&]() {
+		for (int i = 0; i < half; i++)
+			found ^= bag.erase(in.shuffled[i]);
+	});
+	bench_result e = { name, "erase", half, ns / std::max(half, 1), bytes, 1 };
+	results.push_back(e);
+	sink = sink ^ found;
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	if (n <= 0)
+		return 1;
+
+	std::mt19937 rng(42);
+	bench_input in;
+	in.sorted.resize(n);
+	for (int i = 0; i < n; i++)
+		in.sorted[i] = 2 * i;
+	in.shuffled = in.sorted;
+	std::shuffle(in.shuffled.begin(), in.shuffled.end(), rng);
+	in.queries.resize(n);
+	for (int i = 0; i < n; i++)
+		in.queries[i] = (int)(rng() % (2u * n));
+
+	std::vector<bench_result> results;
+	bench_bag<searchable_array_bag>("searchable_array_bag", LINEAR_LIMIT, LINEAR_LIMIT, in, results);
+	bench_bag<searchable_tree_bag>("searchable_tree_bag", LINEAR_LIMIT, LINEAR_LIMIT, in, results);
+	bench_bag<searchable_balanced_tree_bag>("searchable_balanced_tree_bag", INT_MAX, INT_MAX, in, results);
+	bench_bag<searchable_sorted_array_bag>("searchable_sorted_array_bag", LINEAR_LIMIT, INT_MAX, in, results);
+	bench_bag<searchable_hash_bag>("searchable_hash_bag", INT_MAX, INT_MAX, in, results);
+	bench_bag<searchable_bitmap_bag>("searchable_bitmap_bag", INT_MAX, INT_MAX, in, results);
+	bench_bag<searchable_btree_bag>("searchable_btree_bag", INT_MAX, INT_MAX, in, results);
+	bench_bag<frozen_bag>("frozen_bag", REBUILD_LIMIT, INT_MAX, in, results);
+	bench_bag<concurrent_hash_bag>("concurrent_hash_bag", INT_MAX, INT_MAX, in, results);
+	bench_bag<counted_hash_bag>("counted_hash_bag", INT_MAX, INT_MAX, in, results);
+	bench_threads<locked_hash_bag>("locked_hash_bag", in, results);
+	bench_threads<concurrent_hash_bag>("concurrent_hash_bag", in, results);
+	bench_churn<searchable_array_bag>("searchable_array_bag", LINEAR_LIMIT, in, results);
+	bench_churn<searchable_tree_bag>("searchable_tree_bag", INT_MAX, in, results);
+	bench_churn<searchable_balanced_tree_bag>("searchable_balanced_tree_bag", INT_MAX, in, results);
+	bench_churn<searchable_sorted_array_bag>("searchable_sorted_array_bag", LINEAR_LIMIT, in, results);
+	bench_churn<searchable_hash_bag>("searchable_hash_bag", INT_MAX, in, results);
+	bench_churn<searchable_bitmap_bag>("searchable_bitmap_bag", INT_MAX, in, results);
+	bench_churn<searchable_btree_bag>("searchable_btree_bag", INT_MAX, in, results);
+	bench_churn<frozen_bag>("frozen_bag", REBUILD_LIMIT, in, results);
+	bench_churn<concurrent_hash_bag>("concurrent_hash_bag", INT_MAX, in, results);
+	bench_churn<counted_hash_bag>("counted_hash_bag", INT_MAX, in, results);
+	bench_duplicates<searchable_array_bag>("searchable_array_bag", in, results);
+	bench_duplicates<counted_hash_bag>("counted_hash_bag", in, results);
+	bench_iterate<searchable_array_bag>("searchable_array_bag", INT_MAX, in, results);
+	bench_iterate<searchable_tree_bag>("searchable_tree_bag", LINEAR_LIMIT, in, results);
+	bench_iterate<searchable_balanced_tree_bag>("searchable_balanced_tree_bag", INT_MAX, in, results);
+	bench_iterate<searchable_sorted_array_bag>("searchable_sorted_array_bag", INT_MAX, in, results);
+	bench_iterate<searchable_hash_bag>("searchable_hash_bag", INT_MAX, in, results);
+	bench_iterate<searchable_bitmap_bag>("searchable_bitmap_bag", INT_MAX, in, results);
+	bench_iterate<searchable_btree_bag>("searchable_btree_bag", INT_MAX, in, results);
+	bench_iterate<frozen_bag>("frozen_bag", INT_MAX, in, results);
+	bench_iterate<concurrent_hash_bag>("concurrent_hash_bag", INT_MAX, in, results);
+	bench_iterate<counted_hash_bag>("counted_hash_bag", INT_MAX, in, results);
+	bench_order<searchable_balanced_tree_bag>("searchable_balanced_tree_bag", in, results);
+	bench_order<searchable_sorted_array_bag>("searchable_sorted_array_bag", in, results);
+	bench_order<searchable_bitmap_bag>("searchable_bitmap_bag", in, results);
+	bench_trace<null_trace>("tree_bag_trace_off", in, results);
+	bench_trace<ring_trace<int> >("tree_bag_trace_on", in, results);
+	bench_dispatch<static_hash_bag<int> >("static_hash_bag", INT_MAX, in, results);
+	bench_dispatch<static_sorted_array_bag<int> >("static_sorted_array_bag", LINEAR_LIMIT, in, results);
+
+	std::cout << "[" << std::endl;
+	for (size_t i = 0; i < results.size(); i++) {
+		const bench_result &r = results[i];
+		std::cout << "  {\"bag\": \"" << r.bag << "\", \"workload\": \"" << r.workload
+			<< "\", \"n\": " << r.n << ", \"ns_per_op\": " << r.ns_per_op
+			<< ", \"bytes_per_key\": " << r.bytes_per_key << ", \"threads\": " << r.threads << "}"
+			<< (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+	std::cout << "]" << std::endl;
+	return 0;
+}
@@ -0,0 +1,1044 @@
+// Test driver for the bag hierarchy.
+//
+//   g++ -O2 -std=c++11 -pthread *_bag.cpp set.cpp polyset_tests_main.cpp -o polyset_tests
+//   ./polyset_tests
+//
+// Every bag runs the same random sequence of operations as a std::set, or
+// a std::multiset for the bags that keep repeats, and must agree with it
+// after each one. The values cluster around INT_MIN, INT_MAX, zero and the
+// multiples of 65536 where the bitmap bag changes container. The seed is
+// fixed so that a failure can be replayed, and the exit status is 1 when
+// any test fails.
+
+#include "searchable_bag.hpp"
+#include "searchable_array_bag.hpp"
+#include "searchable_tree_bag.hpp"
+#include "searchable_balanced_tree_bag.hpp"
+#include "searchable_sorted_array_bag.hpp"
+#include "searchable_hash_bag.hpp"
+#include "searchable_bitmap_bag.hpp"
+#include "searchable_btree_bag.hpp"
+#include "frozen_bag.hpp"
+#include "concurrent_hash_bag.hpp"
+#include "counted_hash_bag.hpp"
+#include "static_hash_bag.hpp"
+#include "static_sorted_array_bag.hpp"
+#include "virtual_bag.hpp"
+#include "set.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int EDGES[] = {
+	INT_MIN, INT_MIN + 1, -131073, -131072, -65537, -65536, -65535, -1, 0, 1,
+	65535, 65536, 65537, 131071, 131072, INT_MAX - 65536, INT_MAX - 1, INT_MAX
+};
+static const int EDGE_COUNT = sizeof(EDGES) / sizeof(EDGES[0]);
+
+// Every bag behind the searchable_bag interface, for the set algebra.
+static const char *const BAG_NAMES[] = {
+	"array", "tree", "balanced_tree", "sorted_array", "hash",
+	"bitmap", "btree", "frozen", "concurrent_hash", "counted_hash"
+};
+static const int BAG_KINDS = sizeof(BAG_NAMES) / sizeof(BAG_NAMES[0]);
+
+// Bags have no virtual destructor, so each is owned by a shared_ptr made
+// from its concrete type, which deletes it as that type.
+static std::shared_ptr<searchable_bag> make_bag(int kind) {
+	switch (kind) {
+	case 0: return std::shared_ptr<searchable_bag>(new searchable_array_bag());
+	case 1: return std::shared_ptr<searchable_bag>(new searchable_tree_bag());
+	case 2: return std::shared_ptr<searchable_bag>(new searchable_balanced_tree_bag());
+	case 3: return std::shared_ptr<searchable_bag>(new searchable_sorted_array_bag());
+	case 4: return std::shared_ptr<searchable_bag>(new searchable_hash_bag());
+	case 5: return std::shared_ptr<searchable_bag>(new searchable_bitmap_bag());
+	case 6: return std::shared_ptr<searchable_bag>(new searchable_btree_bag());
+	case 7: return std::shared_ptr<searchable_bag>(new frozen_bag());
+	case 8: return std::shared_ptr<searchable_bag>(new concurrent_hash_bag());
+	default: return std::shared_ptr<searchable_bag>(new counted_hash_bag());
+	}
+}
+
+class PolysetTester {
+	private:
+		int passed;
+		int failed;
+		int number;
+		std::mt19937 rng;
+
+	public:
+		PolysetTester() : passed(0), failed(0), number(0), rng(20240611) {}
+
+		void test(bool condition, const std::string &description) {
+			number++;
+			if (condition) {
+				passed++;
+				std::cout << "✓ Test " << number << ": " << description << std::endl;
+			} else {
+				failed++;
+				std::cout << "✗ Test " << number << ": " << description << std::endl;
+			}
+		}
+
+		// An edge value, a value up to 128 away from one, a value near zero
+		// or any int, a quarter of the time each.
+		int value() {
+			switch (rng() % 4) {
+			case 0:
+				return EDGES[rng() % EDGE_COUNT];
+			case 1: {
+				long long v = (long long)EDGES[rng() % EDGE_COUNT] + (int)(rng() % 257) - 128;
+				return (int)std::max<long long>(INT_MIN, std::min<long long>(INT_MAX, v));
+			}
+			case 2:
+				return (int)(rng() % 4097) - 2048;
+			default:
+				return (int)rng();
+			}
+		}
+
+		template <typename Bag>
+		static bool same_contents(const Bag &bag, const std::multiset<int> &ref) {
+			std::vector<int> got;
+			bag.collect(got);
+			std::sort(got.begin(), got.end());
+			return got.size() == ref.size() && std::equal(got.begin(), got.end(), ref.begin());
+		}
+
+		// Runs ops random operations on bag and on ref, which only keeps
+		// repeats when multi is set. Returns an empty string, or the first
+		// operation whose result or aftermath differed.
+		template <typename Bag>
+		std::string run_ops(Bag &bag, std::multiset<int> &ref, bool multi, int ops) {
+			std::ostringstream err;
+			for (int op = 0; op < ops; op++) {
+				int x = value();
+				bool had = ref.count(x) != 0;
+				switch (rng() % 8) {
+				case 0:
+				case 1:
+					bag.insert(x);
+					if (multi || !had)
+						ref.insert(x);
+					break;
+				case 2:
+					if (bag.insert_unique(x) != !had) {
+						err << "op " << op << ": insert_unique(" << x << ")";
+						return err.str();
+					}
+					if (!had)
+						ref.insert(x);
+					break;
+				case 3:
+					if (bag.erase(x) != had) {
+						err << "op " << op << ": erase(" << x << ")";
+						return err.str();
+					}
+					if (had)
+						ref.erase(ref.find(x));
+					break;
+				case 4:
+					if (bag.has(x) != had) {
+						err << "op " << op << ": has(" << x << ")";
+						return err.str();
+					}
+					break;
+				case 5: {
+					int batch[8];
+					for (int i = 0; i < 8; i++) {
+						batch[i] = value();
+						if (multi || !ref.count(batch[i]))
+							ref.insert(batch[i]);
+					}
+					bag.insert(batch, 8);
+					break;
+				}
+				case 6: {
+					int batch[8];
+					std::set<int> fresh;
+					for (int i = 0; i < 8; i++) {
+						batch[i] = value();
+						if (!ref.count(batch[i]))
+							fresh.insert(batch[i]);
+					}
+					if (bag.insert_unique(batch, 8) != (int)fresh.size()) {
+						err << "op " << op << ": insert_unique of a batch of 8";
+						return err.str();
+					}
+					ref.insert(fresh.begin(), fresh.end());
+					break;
+				}
+				default: {
+					// Longer than one 16-lane round, so a short tail is run too.
+					int keys[21];
+					bool out[21];
+					for (int i = 0; i < 21; i++)
+						keys[i] = value();
+					bag.has_batch(keys, 21, out);
+					for (int i = 0; i < 21; i++)
+						if (out[i] != (ref.count(keys[i]) != 0)) {
+							err << "op " << op << ": has_batch, key " << keys[i];
+							return err.str();
+						}
+					break;
+				}
+				}
+				if (op % 64 == 63 && !same_contents(bag, ref)) {
+					err << "op " << op << ": collect()";
+					return err.str();
+				}
+			}
+			if (!same_contents(bag, ref))
+				return "collect() at the end";
+			return "";
+		}
+
+		template <typename Bag>
+		void test_bag(const std::string &name, bool multi, int ops) {
+			const char *model = multi ? "std::multiset" : "std::set";
+			{
+				Bag bag;
+				std::multiset<int> ref;
+				std::string err = run_ops(bag, ref, multi, ops);
+				test(err.empty(), name + ": " + std::to_string(ops) + " random operations agree with " + model
+					+ (err.empty() ? "" : " (" + err + ")"));
+				bag.clear();
+				ref.clear();
+				test(same_contents(bag, ref) && !bag.has(0) && !bag.has(INT_MIN),
+					name + ": clear() leaves nothing behind");
+				err = run_ops(bag, ref, multi, ops / 4);
+				test(err.empty(), name + ": random operations after clear() agree with " + model
+					+ (err.empty() ? "" : " (" + err + ")"));
+			}
+			{
+				Bag bag;
+				bag.insert(INT_MAX);
+				bag.insert(INT_MIN);
+				bool ok = bag.has(INT_MIN) && bag.has(INT_MAX)
+					&& !bag.has(INT_MIN + 1) && !bag.has(INT_MAX - 1) && !bag.has(0);
+				std::vector<int> got;
+				bag.collect(got);
+				std::sort(got.begin(), got.end());
+				ok = ok && got.size() == 2 && got[0] == INT_MIN && got[1] == INT_MAX;
+				ok = ok && !bag.insert_unique(INT_MIN) && !bag.insert_unique(INT_MAX);
+				ok = ok && bag.erase(INT_MIN) && !bag.has(INT_MIN) && bag.has(INT_MAX);
+				ok = ok && bag.erase(INT_MAX) && !bag.has(INT_MAX) && !bag.erase(INT_MAX);
+				got.clear();
+				bag.collect(got);
+				test(ok && got.empty(), name + ": INT_MIN and INT_MAX inserted, found and erased");
+			}
+			{
+				// The last value of one container and the first of the next,
+				// for boundaries from INT_MIN up to INT_MAX.
+				Bag bag;
+				std::multiset<int> ref;
+				std::vector<int> items;
+				for (long long k = -32768; k <= 32768; k += 4096) {
+					long long b = k * 65536;
+					if (b - 1 >= INT_MIN)
+						items.push_back((int)(b - 1));
+					if (b <= INT_MAX)
+						items.push_back((int)b);
+				}
+				for (size_t i = 0; i < items.size(); i++) {
+					bag.insert(items[i]);
+					ref.insert(items[i]);
+				}
+				bool ok = same_contents(bag, ref);
+				for (size_t i = 0; i < items.size(); i++) {
+					int v = items[i];
+					ok = ok && bag.has(v);
+					if (v != INT_MAX && !ref.count(v + 1))
+						ok = ok && !bag.has(v + 1);
+					if (v != INT_MIN && !ref.count(v - 1))
+						ok = ok && !bag.has(v - 1);
+				}
+				for (size_t i = 0; i < items.size(); i += 2) {
+					ok = ok && bag.erase(items[i]);
+					ref.erase(ref.find(items[i]));
+				}
+				test(ok && same_contents(bag, ref), name + ": values on both sides of 65536 boundaries");
+			}
+		}
+
+		// Inserts a bag's own elements into itself, once with room to spare
+		// and once when the insert must move the bag to a bigger buffer.
+		// The strings are too long to be stored inline, so a read of the
+		// freed buffer is a read of freed strings.
+		void test_self_insert() {
+			basic_array_bag<std::string> bag;
+			std::vector<std::string> expect;
+			for (int i = 0; i < 8; i++) {
+				std::string s = "element number " + std::to_string(i) + " of the self-insert test";
+				bag.insert(s);
+				expect.push_back(s);
+			}
+			bag.shrink_to_fit();
+			bag.insert(const_cast<std::string *>(bag.begin()), 8);
+			std::vector<std::string> first(expect);
+			expect.insert(expect.end(), first.begin(), first.end());
+			std::vector<std::string> got(bag.begin(), bag.end());
+			test(got == expect && bag.capacity() >= 16,
+				"basic_array_bag: inserting its own range while growing copies it first");
+
+			bag.reserve(64);
+			bag.insert(const_cast<std::string *>(bag.begin()) + 4, 8);
+			std::vector<std::string> middle(expect.begin() + 4, expect.begin() + 12);
+			expect.insert(expect.end(), middle.begin(), middle.end());
+			got.assign(bag.begin(), bag.end());
+			test(got == expect && bag.capacity() == 64,
+				"basic_array_bag: inserting its own range with room to spare");
+
+			searchable_array_bag ints;
+			for (int i = 0; i < 8; i++)
+				ints.insert(i);
+			ints.shrink_to_fit();
+			ints.insert(const_cast<int *>(ints.begin()), 8);
+			std::vector<int> all(ints.begin(), ints.end());
+			bool ok = all.size() == 16;
+			for (int i = 0; ok && i < 16; i++)
+				ok = all[i] == i % 8;
+			test(ok, "searchable_array_bag: inserting its own range while growing copies it first");
+		}
+
+		// count(), erase_one(), size() and distinct() against a
+		// std::multiset after every operation. Values are drawn from a small
+		// range mixed with the edge values, so most of them repeat.
+		void test_counted(int ops) {
+			counted_hash_bag bag;
+			std::multiset<int> ref;
+			std::string err;
+			for (int op = 0; op < ops && err.empty(); op++) {
+				int x = rng() % 2 ? (int)(rng() % 64) - 32 : EDGES[rng() % EDGE_COUNT];
+				bool had = ref.count(x) != 0;
+				switch (rng() % 4) {
+				case 0:
+				case 1:
+					bag.insert(x);
+					ref.insert(x);
+					break;
+				case 2:
+					if (bag.erase_one(x) != had)
+						err = "erase_one(" + std::to_string(x) + ")";
+					else if (had)
+						ref.erase(ref.find(x));
+					break;
+				default:
+					if (bag.insert_unique(x) != !had)
+						err = "insert_unique(" + std::to_string(x) + ")";
+					else if (!had)
+						ref.insert(x);
+					break;
+				}
+				if (err.empty() && bag.count(x) != (int)ref.count(x))
+					err = "count(" + std::to_string(x) + ")";
+				if (err.empty() && bag.size() != (long long)ref.size())
+					err = "size()";
+				if (err.empty() && bag.distinct() != (int)std::set<int>(ref.begin(), ref.end()).size())
+					err = "distinct()";
+				if (!err.empty())
+					err = "op " + std::to_string(op) + ": " + err;
+			}
+			for (std::multiset<int>::iterator it = ref.begin(); err.empty() && it != ref.end();
+					it = ref.upper_bound(*it))
+				if (bag.count(*it) != (int)ref.count(*it))
+					err = "count(" + std::to_string(*it) + ") at the end";
+			test(err.empty() && same_contents(bag, ref), "counted_hash_bag: count(), size() and distinct() agree with "
+				"std::multiset over " + std::to_string(ops) + " operations" + (err.empty() ? "" : " (" + err + ")"));
+
+			bag.clear();
+			for (int i = 0; i < 5; i++)
+				bag.insert(INT_MIN);
+			bag.insert(7);
+			bool ok = bag.erase_one(INT_MIN) && bag.count(INT_MIN) == 4 && bag.has(INT_MIN)
+				&& bag.size() == 5 && bag.distinct() == 2;
+			for (int i = 0; i < 4; i++)
+				ok = ok && bag.erase_one(INT_MIN);
+			ok = ok && bag.count(INT_MIN) == 0 && !bag.has(INT_MIN) && !bag.erase_one(INT_MIN)
+				&& bag.count(7) == 1 && bag.size() == 1 && bag.distinct() == 1;
+			test(ok, "counted_hash_bag: erase_one() of a value with five copies leaves four");
+		}
+
+		void runDifferentialTests() {
+			std::cout << "=== Differential Tests ===" << std::endl;
+			test_bag<searchable_array_bag>("searchable_array_bag", true, 4000);
+			test_self_insert();
+			test_bag<searchable_tree_bag>("searchable_tree_bag", false, 4000);
+			test_bag<searchable_balanced_tree_bag>("searchable_balanced_tree_bag", false, 4000);
+			test_bag<searchable_sorted_array_bag>("searchable_sorted_array_bag", true, 4000);
+			test_bag<searchable_hash_bag>("searchable_hash_bag", false, 4000);
+			test_bag<searchable_bitmap_bag>("searchable_bitmap_bag", false, 4000);
+			test_bag<searchable_btree_bag>("searchable_btree_bag", false, 4000);
+			test_bag<frozen_bag>("frozen_bag", false, 4000);
+			test_bag<concurrent_hash_bag>("concurrent_hash_bag", false, 4000);
+			test_bag<counted_hash_bag>("counted_hash_bag", true, 4000);
+			test_counted(4000);
+			test_bag<virtual_bag<static_hash_bag<int> > >("static_hash_bag", false, 4000);
+			test_bag<virtual_bag<static_sorted_array_bag<int> > >("static_sorted_array_bag", true, 4000);
+		}
+
+		// Checks rank, select, count_range, lower_bound and upper_bound of
+		// bag against ref at the edge values, at every stored value and its
+		// neighbours, and at select() indices -1 to two past the end.
+		// Returns an empty string, or the first query that differed.
+		template <typename Bag>
+		std::string check_order(const Bag &bag, const std::multiset<int> &ref) {
+			std::ostringstream err;
+			std::vector<int> sorted(ref.begin(), ref.end());
+			std::vector<int> queries(EDGES, EDGES + EDGE_COUNT);
+			for (size_t i = 0; i < sorted.size(); i++) {
+				queries.push_back(sorted[i]);
+				if (sorted[i] != INT_MIN)
+					queries.push_back(sorted[i] - 1);
+				if (sorted[i] != INT_MAX)
+					queries.push_back(sorted[i] + 1);
+			}
+			for (size_t i = 0; i < queries.size(); i++) {
+				int q = queries[i];
+				std::vector<int>::iterator lo = std::lower_bound(sorted.begin(), sorted.end(), q);
+				std::vector<int>::iterator hi = std::upper_bound(sorted.begin(), sorted.end(), q);
+				int out = 0;
+				if (bag.rank(q) != lo - sorted.begin()) {
+					err << "rank(" << q << ")";
+					return err.str();
+				}
+				bool found = bag.lower_bound(q, out);
+				if (found != (lo != sorted.end()) || (found && out != *lo)) {
+					err << "lower_bound(" << q << ")";
+					return err.str();
+				}
+				found = bag.upper_bound(q, out);
+				if (found != (hi != sorted.end()) || (found && out != *hi)) {
+					err << "upper_bound(" << q << ")";
+					return err.str();
+				}
+				// The pair in both orders: low > high must count nothing.
+				int r = queries[rng() % queries.size()];
+				int low = std::min(q, r), high = std::max(q, r);
+				long long expect = std::upper_bound(sorted.begin(), sorted.end(), high)
+					- std::lower_bound(sorted.begin(), sorted.end(), low);
+				if (bag.count_range(low, high) != expect) {
+					err << "count_range(" << low << ", " << high << ")";
+					return err.str();
+				}
+				if (low != high && bag.count_range(high, low) != 0) {
+					err << "count_range(" << high << ", " << low << ")";
+					return err.str();
+				}
+			}
+			for (long long k = -1; k <= (long long)sorted.size() + 1; k++) {
+				int out = 0;
+				bool found = bag.select(k, out);
+				bool in_range = k >= 0 && k < (long long)sorted.size();
+				if (found != in_range || (found && out != sorted[k])) {
+					err << "select(" << k << ")";
+					return err.str();
+				}
+			}
+			int out = 0;
+			if (bag.select(INT_MIN, out) || bag.select(INT_MAX, out))
+				return "select(INT_MIN) or select(INT_MAX)";
+			return "";
+		}
+
+		template <typename Bag>
+		void test_order(const std::string &name, bool multi) {
+			{
+				Bag bag;
+				int out = 0;
+				test(bag.rank(0) == 0 && !bag.select(0, out) && !bag.select(-1, out)
+					&& bag.count_range(INT_MIN, INT_MAX) == 0
+					&& !bag.lower_bound(INT_MIN, out) && !bag.upper_bound(INT_MIN, out),
+					name + ": order statistics of an empty bag");
+			}
+			{
+				Bag bag;
+				std::multiset<int> ref;
+				std::string err = run_ops(bag, ref, multi, 2000);
+				if (err.empty())
+					err = check_order(bag, ref);
+				test(err.empty(), name + ": order statistics after random operations"
+					+ (err.empty() ? "" : " (" + err + ")"));
+			}
+			{
+				// Erases that leave holes in the middle, fewer than half the
+				// elements so that the sorted array keeps its tombstones.
+				Bag bag;
+				std::multiset<int> ref;
+				for (int i = 0; i < 1000; i++) {
+					bag.insert(i * 3);
+					ref.insert(i * 3);
+				}
+				for (int i = 300; i < 500; i++) {
+					bag.erase(i * 3);
+					ref.erase(ref.find(i * 3));
+				}
+				for (int i = 600; i < 900; i += 7) {
+					bag.erase(i * 3);
+					ref.erase(ref.find(i * 3));
+				}
+				int out = 0;
+				std::string err = check_order(bag, ref);
+				bool hole = bag.rank(1200) == 300 && bag.count_range(900, 1499) == 0
+					&& bag.lower_bound(900, out) && out == 1500
+					&& bag.upper_bound(897, out) && out == 1500
+					&& bag.select(300, out) && out == 1500;
+				test(err.empty() && hole, name + ": order statistics across erased runs mid-bag"
+					+ (err.empty() ? "" : " (" + err + ")"));
+			}
+		}
+
+		void runOrderStatisticTests() {
+			std::cout << "\n=== Order Statistic Tests ===" << std::endl;
+			test_order<searchable_sorted_array_bag>("searchable_sorted_array_bag", true);
+			test_order<searchable_balanced_tree_bag>("searchable_balanced_tree_bag", false);
+			test_order<searchable_bitmap_bag>("searchable_bitmap_bag", false);
+			{
+				// Repeats count once per copy, and tombstones sit between them.
+				searchable_sorted_array_bag bag;
+				std::multiset<int> ref;
+				for (int i = 0; i < 5; i++)
+					for (int v = 10; v <= 50; v += 10) {
+						bag.insert(v);
+						ref.insert(v);
+					}
+				bag.erase(30);
+				bag.erase(30);
+				ref.erase(ref.find(30));
+				ref.erase(ref.find(30));
+				int out = 0;
+				std::string err = check_order(bag, ref);
+				test(err.empty() && bag.rank(30) == 10 && bag.rank(31) == 13 && bag.count_range(30, 30) == 3
+					&& bag.select(12, out) && out == 30 && bag.select(13, out) && out == 40,
+					"searchable_sorted_array_bag: repeats with some copies erased"
+					+ (err.empty() ? "" : " (" + err + ")"));
+			}
+		}
+
+		// n distinct values from [base, base + 3n), sorted, with INT_MIN or
+		// INT_MAX swapped in at random so the compares see both signs.
+		std::vector<int> algebra_values(int n, int base) {
+			std::set<int> chosen;
+			while ((int)chosen.size() < n) {
+				int r = (int)(rng() % 64);
+				if (r == 0)
+					chosen.insert(INT_MIN);
+				else if (r == 1)
+					chosen.insert(INT_MAX);
+				else
+					chosen.insert(base + (int)(rng() % (unsigned)(3 * n)));
+			}
+			return std::vector<int>(chosen.begin(), chosen.end());
+		}
+
+		// A bag of the given kind holding values, the bags that keep repeats
+		// holding each of them twice. The items go in shuffled, since sorted
+		// input would degenerate tree_bag.
+		std::shared_ptr<searchable_bag> filled_bag(int kind, const std::vector<int> &values) {
+			std::shared_ptr<searchable_bag> b = make_bag(kind);
+			std::vector<int> items(values);
+			items.insert(items.end(), values.begin(), values.end());
+			std::shuffle(items.begin(), items.end(), rng);
+			if (!items.empty())
+				b->insert(items.data(), (int)items.size());
+			return b;
+		}
+
+		// Repeats are ignored: filled_bag() stores them.
+		static bool holds(const searchable_bag &b, const std::vector<int> &expect) {
+			std::vector<int> got;
+			b.collect(got);
+			std::sort(got.begin(), got.end());
+			got.erase(std::unique(got.begin(), got.end()), got.end());
+			return got == expect;
+		}
+
+		// Runs the four operations on bags of kinds ka and kb holding va and
+		// vb, into a bag of kind ko and into either operand's own bag.
+		// Returns an empty string, or the first operation that differed.
+		std::string check_algebra(int ka, int kb, int ko, const std::vector<int> &va, const std::vector<int> &vb) {
+			std::vector<int> uni, inter, diff;
+			std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(uni));
+			std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(inter));
+			std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(diff));
+			bool subset = std::includes(vb.begin(), vb.end(), va.begin(), va.end());
+			bool superset = std::includes(va.begin(), va.end(), vb.begin(), vb.end());
+
+			std::shared_ptr<searchable_bag> a = filled_bag(ka, va);
+			std::shared_ptr<searchable_bag> b = filled_bag(kb, vb);
+			set sa(*a), sb(*b);
+			std::shared_ptr<searchable_bag> out = make_bag(ko);
+			out->insert(12345);
+			sa.set_union(sb, *out);
+			if (!holds(*out, uni))
+				return std::string("union into ") + BAG_NAMES[ko];
+			sa.set_intersection(sb, *out);
+			if (!holds(*out, inter))
+				return std::string("intersection into ") + BAG_NAMES[ko];
+			sa.set_difference(sb, *out);
+			if (!holds(*out, diff))
+				return std::string("difference into ") + BAG_NAMES[ko];
+			if (sa.is_subset(sb) != subset || sb.is_subset(sa) != superset)
+				return "is_subset";
+			if (!holds(*a, va) || !holds(*b, vb))
+				return "an operand changed";
+
+			// The result written over an operand that is also read.
+			sa.set_intersection(sb, sa.get_bag());
+			if (!holds(*a, inter))
+				return "a.set_intersection(b, a)";
+			a = filled_bag(ka, va);
+			sa = set(*a);
+			sa.set_union(sb, sb.get_bag());
+			if (!holds(*b, uni))
+				return "a.set_union(b, b)";
+			b = filled_bag(kb, vb);
+			sb = set(*b);
+			sa.set_difference(sb, sa.get_bag());
+			if (!holds(*a, diff))
+				return "a.set_difference(b, a)";
+			a = filled_bag(ka, va);
+			sa = set(*a);
+			sa.set_difference(sb, sb.get_bag());
+			if (!holds(*b, diff))
+				return "a.set_difference(b, b)";
+			return "";
+		}
+
+		void runSetAlgebraTests() {
+			std::cout << "\n=== Set Algebra Tests ===" << std::endl;
+			// Every pair of kinds, on disjoint, overlapping, equal and nested
+			// contents of several sizes.
+			const int sizes[] = { 0, 1, 5, 40, 300 };
+			for (int ka = 0; ka < BAG_KINDS; ka++)
+				for (int kb = 0; kb < BAG_KINDS; kb++) {
+					std::string err;
+					int ko = (ka + kb + 1) % BAG_KINDS;
+					for (int si = 0; si < 5 && err.empty(); si++) {
+						int n = sizes[si];
+						std::vector<int> va = algebra_values(n, -n);
+						std::vector<int> vb = algebra_values(n + (int)(rng() % 7), -n + (int)(rng() % (n + 1)));
+						std::vector<int> far = algebra_values(n, 100000 + 4 * n);
+						std::vector<int> more(va);
+						more.insert(more.end(), far.begin(), far.end());
+						std::sort(more.begin(), more.end());
+						more.erase(std::unique(more.begin(), more.end()), more.end());
+						err = check_algebra(ka, kb, ko, va, vb);
+						if (err.empty())
+							err = check_algebra(ka, kb, ko, va, far);
+						if (err.empty())
+							err = check_algebra(ka, kb, ko, va, va);
+						if (err.empty())
+							err = check_algebra(ka, kb, ko, va, more);
+						if (err.empty())
+							err = check_algebra(ka, kb, ko, more, va);
+					}
+					test(err.empty(), std::string("set algebra: ") + BAG_NAMES[ka] + " with " + BAG_NAMES[kb]
+						+ (err.empty() ? "" : " (" + err + ")"));
+				}
+
+			// Every pair of sizes up to three 4-lane blocks, so that each
+			// tail length meets each other one.
+			std::string err;
+			for (int na = 0; na <= 12 && err.empty(); na++)
+				for (int nb = 0; nb <= 12 && err.empty(); nb++)
+					for (int trial = 0; trial < 4 && err.empty(); trial++) {
+						std::vector<int> va = algebra_values(na, 0);
+						std::vector<int> vb = algebra_values(nb, 0);
+						err = check_algebra(trial % 2 ? 3 : 0, trial % 2 ? 1 : 3, 4, va, vb);
+						if (!err.empty())
+							err += ", sizes " + std::to_string(na) + " and " + std::to_string(nb);
+					}
+			test(err.empty(), "set algebra: every pair of sizes from 0 to 12"
+				+ (err.empty() ? "" : " (" + err + ")"));
+
+			// Bitmap with bitmap takes the word-by-word path; these are dense
+			// enough for bitmap containers, and straddle a container boundary.
+			err.clear();
+			for (int trial = 0; trial < 3 && err.empty(); trial++) {
+				std::vector<int> va, vb;
+				for (int v = 60000; v < 140000; v++) {
+					if (rng() % 3)
+						va.push_back(v);
+					if (rng() % 4 == 0)
+						vb.push_back(v);
+				}
+				err = check_algebra(5, 5, 5, va, vb);
+				if (err.empty())
+					err = check_algebra(5, 5, 3, va, vb);
+				if (err.empty())
+					err = check_algebra(5, 3, 5, va, vb);
+			}
+			test(err.empty(), "set algebra: dense bitmaps across a container boundary"
+				+ (err.empty() ? "" : " (" + err + ")"));
+		}
+
+		// bag holds exactly ref, listed in signed order, and its containers
+		// are of the kinds given.
+		static bool bitmap_state(const searchable_bitmap_bag &bag, const std::set<int> &ref,
+				int arrays, int bitmaps, int runs) {
+			std::vector<int> got;
+			bag.collect(got);
+			int a = 0, b = 0, r = 0;
+			bag.container_counts(a, b, r);
+			return a == arrays && b == bitmaps && r == runs && bag.cardinality() == (long long)ref.size()
+				&& got.size() == ref.size() && std::equal(got.begin(), got.end(), ref.begin());
+		}
+
+		// Every transition between ARRAY, BITMAP and RUN within the container
+		// that starts at base.
+		void test_containers(int base) {
+			std::string where = " (container at " + std::to_string(base) + ")";
+			{
+				// Even offsets only, so there are no runs to pay off.
+				searchable_bitmap_bag bag;
+				std::set<int> ref;
+				for (int i = 0; i < 4096; i++) {
+					bag.insert(base + 2 * i);
+					ref.insert(base + 2 * i);
+				}
+				bool ok = bitmap_state(bag, ref, 1, 0, 0);
+				bag.insert(base + 8192);
+				ref.insert(base + 8192);
+				ok = ok && bitmap_state(bag, ref, 0, 1, 0);
+				test(ok, "bitmap: ARRAY becomes BITMAP on the insert past 4096" + where);
+
+				bag.erase(base);
+				ref.erase(base);
+				ok = bitmap_state(bag, ref, 1, 0, 0);
+				for (int i = 0; i < 4 && ok; i++) {
+					int in = i % 2 ? base + 4000 : base;
+					int out = i % 2 ? base : base + 4000;
+					bag.insert(in);
+					ref.insert(in);
+					ok = bitmap_state(bag, ref, 0, 1, 0);
+					bag.erase(out);
+					ref.erase(out);
+					ok = ok && bitmap_state(bag, ref, 1, 0, 0);
+				}
+				test(ok, "bitmap: BITMAP becomes ARRAY on the erase down to 4096, back and forth" + where);
+
+				while (!ref.empty()) {
+					bag.erase(*ref.begin());
+					ref.erase(ref.begin());
+				}
+				test(bitmap_state(bag, ref, 0, 0, 0) && !bag.has(base),
+					"bitmap: an emptied container is dropped" + where);
+			}
+			{
+				std::vector<int> items;
+				for (int i = 0; i < 5000; i++)
+					items.push_back(base + 2 * i);
+				searchable_bitmap_bag bag;
+				std::set<int> ref(items.begin(), items.end());
+				bag.insert(items.data(), (int)items.size());
+				bool ok = bitmap_state(bag, ref, 0, 1, 0);
+				for (int i = 0; i < 903; i++) {
+					bag.erase(items[i * 5]);
+					ref.erase(items[i * 5]);
+				}
+				ok = ok && bitmap_state(bag, ref, 0, 1, 0);
+				bag.erase(items[1]);
+				ref.erase(items[1]);
+				ok = ok && bitmap_state(bag, ref, 1, 0, 0);
+				test(ok, "bitmap: a bulk insert past 4096 and erases back to it" + where);
+			}
+			{
+				// One run of 10000, split by erases until the runs stop paying
+				// off at 2048 of them.
+				std::vector<int> items;
+				for (int i = 0; i < 10000; i++)
+					items.push_back(base + i);
+				searchable_bitmap_bag bag;
+				std::set<int> ref(items.begin(), items.end());
+				bag.insert(items.data(), (int)items.size());
+				bool ok = bitmap_state(bag, ref, 0, 0, 1);
+				bag.erase(base + 5000);
+				ref.erase(base + 5000);
+				ok = ok && bitmap_state(bag, ref, 0, 0, 1) && bag.has(base + 4999) && bag.has(base + 5001);
+				bag.erase(base);
+				bag.erase(base + 9999);
+				ref.erase(base);
+				ref.erase(base + 9999);
+				ok = ok && bitmap_state(bag, ref, 0, 0, 1);
+				int runs = 2;
+				for (int v = 3; v < 9990 && ok; v += 3) {
+					if (v == 5001 || v == 4998)
+						continue;
+					bag.erase(base + v);
+					ref.erase(base + v);
+					runs++;
+					ok = bitmap_state(bag, ref, 0, runs < 2048 ? 0 : 1, runs < 2048 ? 1 : 0);
+				}
+				test(ok, "bitmap: RUN split by erases, then BITMAP at 2048 runs" + where);
+			}
+			{
+				// 3000 values in one run: every other one erased, until ARRAY
+				// is the smaller at 1001 runs.
+				std::vector<int> items;
+				for (int i = 0; i < 3000; i++)
+					items.push_back(base + i);
+				searchable_bitmap_bag bag;
+				std::set<int> ref(items.begin(), items.end());
+				bag.insert(items.data(), (int)items.size());
+				bool ok = bitmap_state(bag, ref, 0, 0, 1);
+				for (int k = 1; k < 1500 && ok; k++) {
+					bag.erase(base + 2 * k - 1);
+					ref.erase(base + 2 * k - 1);
+					// k + 1 runs of 4 bytes against 3000 - k values of 2.
+					bool run = 4 * (k + 1) < 2 * (3000 - k);
+					ok = bitmap_state(bag, ref, run ? 0 : 1, 0, run ? 1 : 0);
+				}
+				// Filling the holes back in joins the runs again; a bulk
+				// insert re-encodes to the smallest form.
+				for (int v = 1; v < 2999; v += 2)
+					ref.insert(base + v);
+				std::vector<int> holes;
+				for (int v = 1; v < 2999; v += 2)
+					holes.push_back(base + v);
+				bag.insert(holes.data(), (int)holes.size());
+				ok = ok && bitmap_state(bag, ref, 0, 0, 1);
+				test(ok, "bitmap: RUN becomes ARRAY as erases split it, and RUN again after a bulk insert" + where);
+			}
+			{
+				// Single inserts into a RUN: next to a run, joining two, and
+				// apart from both, until BITMAP is the smaller.
+				std::vector<int> items;
+				for (int i = 0; i < 8000; i++)
+					items.push_back(base + i);
+				searchable_bitmap_bag bag;
+				std::set<int> ref(items.begin(), items.end());
+				bag.insert(items.data(), (int)items.size());
+				bag.erase(base + 100);
+				ref.erase(base + 100);
+				bag.insert(base + 100);
+				ref.insert(base + 100);
+				bool ok = bitmap_state(bag, ref, 0, 0, 1);
+				bag.insert(base + 8000);
+				bag.insert(base + 8002);
+				bag.insert(base + 8001);
+				ref.insert(base + 8000);
+				ref.insert(base + 8001);
+				ref.insert(base + 8002);
+				ok = ok && bitmap_state(bag, ref, 0, 0, 1);
+				int runs = 1;
+				for (int v = 8004; v < 65536 && ok; v += 2) {
+					bag.insert(base + v);
+					ref.insert(base + v);
+					runs++;
+					ok = bitmap_state(bag, ref, 0, runs < 2048 ? 0 : 1, runs < 2048 ? 1 : 0);
+					if (runs > 2050)
+						break;
+				}
+				test(ok, "bitmap: RUN grown by single inserts, then BITMAP at 2048 runs" + where);
+			}
+		}
+
+		void runBitmapContainerTests() {
+			std::cout << "\n=== Bitmap Container Tests ===" << std::endl;
+			test_containers(0);
+			test_containers(-65536);
+			test_containers(INT_MIN);
+			test_containers(INT_MAX - 65535);
+		}
+
+		// Drives a tree bag with an 8-event ring_trace through a fixed run:
+		// seven inserts that build a full tree of depth 2, three duplicates,
+		// two erases and an erase of an absent value, then clear(). The
+		// thirteen events overflow the ring, which must then hold the last
+		// eight, oldest first.
+		void runTraceTests() {
+			std::cout << "\n=== Trace Tests ===" << std::endl;
+			typedef ring_trace<int, 8> trace_type;
+			basic_searchable_tree_bag<int, std::less<int>, std::allocator<int>, trace_type> bag;
+			const trace_type &trace = bag.tracer();
+			int items[] = { 50, 30, 70, 20, 40, 60, 80 };
+			bag.insert(items, 7);
+			test(trace.allocation_count() == 7 && trace.max_depth() == 2
+				&& trace.mean_depth() == 10.0 / 7 && trace.size() == 7 && trace.total() == 7,
+				"ring_trace: seven inserts counted with depths 0, 1, 1 and 2, 2, 2, 2");
+
+			bag.insert(40);
+			bag.insert(50);
+			bool unique = bag.insert_unique(70);
+			test(!unique && trace.duplicate_count() == 3 && trace.allocation_count() == 7,
+				"ring_trace: three duplicates counted, no node allocated");
+
+			bool erased = bag.erase(30) && bag.erase(80) && !bag.erase(99);
+			test(erased && trace.free_count() == 2 && trace.total() == 12 && trace.size() == 8,
+				"ring_trace: two erases counted, the absent value not");
+
+			bag.clear();
+			test(trace.clear_count() == 1 && trace.free_count() == 2 && trace.total() == 13
+				&& trace.size() == 8, "ring_trace: clear() counted once, not as frees");
+
+			// Events 5 to 12 of the run, in order.
+			const trace_type::kind kinds[] = {
+				trace_type::ALLOCATE, trace_type::ALLOCATE, trace_type::DUPLICATE, trace_type::DUPLICATE,
+				trace_type::DUPLICATE, trace_type::FREE, trace_type::FREE, trace_type::CLEAR
+			};
+			const int values[] = { 60, 80, 40, 50, 70, 30, 80, 0 };
+			const int depths[] = { 2, 2, 2, 0, 1, 0, 0, 0 };
+			bool ok = true;
+			for (size_t i = 0; i < trace.size(); i++) {
+				const trace_type::event &e = trace.at(i);
+				ok = ok && e.type == kinds[i] && e.value == values[i] && e.depth == depths[i];
+			}
+			test(ok, "ring_trace: after wrapping, at() lists the last eight events oldest first");
+
+			bag.insert(10);
+			test(trace.allocation_count() == 8 && trace.max_depth() == 2 && trace.mean_depth() == 10.0 / 8
+				&& trace.at(trace.size() - 1).type == trace_type::ALLOCATE && trace.at(0).value == 80,
+				"ring_trace: an insert after clear() is the newest event at depth 0");
+		}
+
+		// Writers, erasers and readers on one concurrent_hash_bag at once.
+		// Each writer inserts its own range plus a range they all share;
+		// the erasers take out every third key of the writers' ranges,
+		// retrying until its insert has landed, so the end state is fixed.
+		// Readers meanwhile look up keys stored before the start and never
+		// erased, which must always be found, and keys never inserted, and
+		// walk the bag, which must list every stable key exactly once.
+		// Writers grow the tables and erasers leave tombstones, so readers
+		// race table retirement throughout.
+		void runConcurrentTests() {
+			std::cout << "\n=== Concurrent Tests ===" << std::endl;
+			const int WRITERS = 8;
+			const int ERASERS = 4;
+			const int READERS = 4;
+			const int PER_WRITER = 12000;
+			const int SHARED = 1000;
+			const int STABLE = 2000;
+			const int STABLE_BASE = -1000000;
+			const int ABSENT_BASE = -2000000;
+
+			concurrent_hash_bag bag;
+			for (int i = 0; i < STABLE; i++)
+				bag.insert(STABLE_BASE + i);
+			std::atomic<int> writers_left(WRITERS);
+			std::atomic<int> wrong_has(0);
+			std::atomic<int> wrong_batch(0);
+			std::atomic<int> wrong_walk(0);
+			std::atomic<int> walks(0);
+			std::vector<std::thread> threads;
+
+			for (int w = 0; w < WRITERS; w++)
+				threads.push_back(std::thread([&bag, &writers_left, w, PER_WRITER, SHARED]() {
+					for (int i = 0; i < PER_WRITER; i++) {
+						bag.insert((w + 1) * 100000 + i);
+						if (i % 12 == 0)
+							bag.insert(i % SHARED);
+					}
+					for (int i = 0; i < SHARED; i++)
+						bag.insert(i);
+					writers_left.fetch_sub(1);
+				}));
+			for (int e = 0; e < ERASERS; e++)
+				threads.push_back(std::thread([&bag, e, WRITERS, ERASERS, PER_WRITER]() {
+					for (int w = e; w < WRITERS; w += ERASERS)
+						for (int i = 0; i < PER_WRITER; i += 3)
+							while (!bag.erase((w + 1) * 100000 + i))
+								std::this_thread::yield();
+				}));
+			for (int r = 0; r < READERS; r++)
+				threads.push_back(std::thread([&, r]() {
+					std::mt19937 local(r);
+					int keys[64];
+					bool out[64];
+					while (writers_left.load() > 0) {
+						for (int i = 0; i < 200; i++) {
+							int k = (int)(local() % STABLE);
+							if (!bag.has(STABLE_BASE + k) || bag.has(ABSENT_BASE + k))
+								wrong_has.fetch_add(1);
+						}
+						for (int i = 0; i < 64; i++)
+							keys[i] = (i % 2 ? STABLE_BASE : ABSENT_BASE) + (int)(local() % STABLE);
+						bag.has_batch(keys, 64, out);
+						for (int i = 0; i < 64; i++)
+							if (out[i] != (i % 2 == 1))
+								wrong_batch.fetch_add(1);
+						std::vector<int> seen(STABLE, 0);
+						for (concurrent_hash_bag::const_iterator it = bag.begin(); it != bag.end(); ++it) {
+							int v = *it;
+							if (v >= STABLE_BASE && v < STABLE_BASE + STABLE)
+								seen[v - STABLE_BASE]++;
+							else if (v >= ABSENT_BASE && v < ABSENT_BASE + STABLE)
+								wrong_walk.fetch_add(1);
+						}
+						for (int i = 0; i < STABLE; i++)
+							if (seen[i] != 1)
+								wrong_walk.fetch_add(1);
+						walks.fetch_add(1);
+					}
+				}));
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+
+			std::vector<int> expect;
+			for (int i = 0; i < STABLE; i++)
+				expect.push_back(STABLE_BASE + i);
+			for (int i = 0; i < SHARED; i++)
+				expect.push_back(i);
+			for (int w = 0; w < WRITERS; w++)
+				for (int i = 0; i < PER_WRITER; i++)
+					if (i % 3)
+						expect.push_back((w + 1) * 100000 + i);
+			std::sort(expect.begin(), expect.end());
+
+			test(wrong_has.load() == 0, "concurrent_hash_bag: has() right for stable and absent keys under "
+				+ std::to_string(WRITERS) + " writers, " + std::to_string(ERASERS) + " erasers and "
+				+ std::to_string(READERS) + " readers");
+			test(wrong_batch.load() == 0, "concurrent_hash_bag: has_batch() right under concurrent writes");
+			test(wrong_walk.load() == 0 && walks.load() > 0,
+				"concurrent_hash_bag: " + std::to_string(walks.load()) + " concurrent walks each saw every stable key once");
+
+			std::vector<int> collected;
+			bag.collect(collected);
+			std::sort(collected.begin(), collected.end());
+			std::vector<int> walked(bag.begin(), bag.end());
+			std::sort(walked.begin(), walked.end());
+			test(bag.size() == (int)expect.size() && collected == expect && walked == expect,
+				"concurrent_hash_bag: size(), collect() and the iterator agree after the threads join");
+
+			bag.reclaim();
+			bool ok = true;
+			for (size_t i = 0; i < expect.size(); i++)
+				ok = ok && bag.has(expect[i]);
+			bag.clear();
+			bag.reclaim();
+			collected.clear();
+			bag.collect(collected);
+			test(ok && collected.empty() && bag.size() == 0 && bag.begin() == bag.end(),
+				"concurrent_hash_bag: reclaim() keeps the live tables, clear() empties the bag");
+		}
+
+		int runAllTests() {
+			std::cout << "Starting polyset test suite...\n" << std::endl;
+			runDifferentialTests();
+			runOrderStatisticTests();
+			runSetAlgebraTests();
+			runBitmapContainerTests();
+			runTraceTests();
+			runConcurrentTests();
+
+			std::cout << "\n=== TEST SUMMARY ===" << std::endl;
+			std::cout << "Passed: " << passed << std::endl;
+			std::cout << "Failed: " << failed << std::endl;
+			std::cout << "Total:  " << (passed + failed) << std::endl;
+			return failed;
+		}
+};
+
+int main() {
+	PolysetTester tester;
+	return tester.runAllTests() ? 1 : 0;
+}
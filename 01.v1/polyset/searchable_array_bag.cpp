@@ -1 +1,3 @@
-#include "searchable_array_bag.hpp"
\ No newline at end of file
+#include "searchable_array_bag.hpp"
+
+template class basic_searchable_array_bag<int>;
@@ -1,25 +1,77 @@
 #pragma once
 #include "searchable_bag.hpp"
 #include "array_bag.hpp"
+#include <functional>
+#include <utility>
 
-class searchable_array_bag : public searchable_bag, public array_bag {
+template <typename T, typename Equal = std::equal_to<T>, typename Alloc = std::allocator<T> >
+class basic_searchable_array_bag : public basic_searchable_bag<T>, public basic_array_bag<T, Alloc> {
+
+	private:
+	Equal equal;
 
 	public:
-	searchable_array_bag() : array_bag() {}
-	searchable_array_bag(const searchable_array_bag &other) : array_bag(other) {}
-	searchable_array_bag &operator=(const searchable_array_bag &other) {
-		if (this != &other)
-			array_bag::operator=(other);
+	basic_searchable_array_bag() : basic_array_bag<T, Alloc>() {}
+	basic_searchable_array_bag(const basic_searchable_array_bag &other)
+		: basic_array_bag<T, Alloc>(other), equal(other.equal) {}
+	basic_searchable_array_bag &operator=(const basic_searchable_array_bag &other) {
+		if (this != &other) {
+			basic_array_bag<T, Alloc>::operator=(other);
+			equal = other.equal;
+		}
+		return *this;
+	}
+	basic_searchable_array_bag(basic_searchable_array_bag &&other) noexcept
+		: basic_array_bag<T, Alloc>(std::move(other)), equal(other.equal) {}
+	basic_searchable_array_bag &operator=(basic_searchable_array_bag &&other) noexcept {
+		if (this != &other) {
+			basic_array_bag<T, Alloc>::operator=(std::move(other));
+			equal = other.equal;
+		}
 		return *this;
 	}
-	~searchable_array_bag() {}
+	~basic_searchable_array_bag() {}
+
+	void swap(basic_searchable_array_bag &other) noexcept {
+		basic_array_bag<T, Alloc>::swap(other);
+		std::swap(equal, other.equal);
+	}
+
+	bool insert_unique(T item) {
+		if (has(item))
+			return false;
+		basic_array_bag<T, Alloc>::insert(item);
+		return true;
+	}
+	// A lookup here is a scan either way, so screening through has_batch()
+	// first would only scan the misses twice.
+	int insert_unique(T *items, int count) {
+		int inserted = 0;
+		for (int i = 0; i < count; i++)
+			inserted += insert_unique(items[i]);
+		return inserted;
+	}
+
+	bool has(T item) const {
+		for (int i = 0; i < this->size; i++) {
+			if (equal(this->data[i], item))
+				return true;
+		}
+		return false;
+	}
 
-	bool has(int item) const {
-		for (int i = 0; i < size; i++) {
-			if (data[i] == item)
+	// The scan is the cost; the hole is filled from the end.
+	bool erase(T item) {
+		for (int i = 0; i < this->size; i++) {
+			if (equal(this->data[i], item)) {
+				this->remove_at(i);
 				return true;
+			}
 		}
 		return false;
 	}
 
-};
\ No newline at end of file
+};
+
+extern template class basic_searchable_array_bag<int>;
+typedef basic_searchable_array_bag<int> searchable_array_bag;
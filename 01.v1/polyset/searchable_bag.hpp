@@ -1,8 +1,46 @@
 #pragma once
 
 #include "bag.hpp"
+#include <algorithm>
 
-class searchable_bag : virtual public bag {
+template <typename T>
+class basic_searchable_bag : virtual public basic_bag<T> {
 public:
-	virtual bool has(int) const = 0;
-};
\ No newline at end of file
+	virtual bool has(T) const = 0;
+	// Removes one copy of item and reports whether there was one.
+	virtual bool erase(T item) = 0;
+	// out[i] = has(keys[i]). Bags whose lookups miss the cache override
+	// this to overlap the misses of several keys; the default asks one key
+	// at a time.
+	virtual void has_batch(const T *keys, int n, bool *out) const {
+		for (int i = 0; i < n; i++)
+			out[i] = has(keys[i]);
+	}
+	// Inserts item unless it is already present and reports whether it did.
+	// Concrete bags override this to find the slot in the same traversal
+	// that checks for the item; the default looks it up, then inserts.
+	virtual bool insert_unique(T item) {
+		if (has(item))
+			return false;
+		this->insert(item);
+		return true;
+	}
+	// Batched form; returns the number of items inserted. The default
+	// screens the items in chunks through has_batch() and passes only the
+	// misses to insert_unique(), which also catches repeats within a chunk.
+	virtual int insert_unique(T *items, int count) {
+		const int CHUNK = 256;
+		bool found[CHUNK];
+		int inserted = 0;
+		for (int base = 0; base < count; base += CHUNK) {
+			int n = std::min(CHUNK, count - base);
+			has_batch(items + base, n, found);
+			for (int i = 0; i < n; i++)
+				if (!found[i])
+					inserted += insert_unique(items[base + i]);
+		}
+		return inserted;
+	}
+};
+
+typedef basic_searchable_bag<int> searchable_bag;
@@ -0,0 +1,3 @@
+#include "searchable_balanced_tree_bag.hpp"
+
+template class basic_searchable_balanced_tree_bag<int>;
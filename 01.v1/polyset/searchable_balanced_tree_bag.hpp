@@ -0,0 +1,62 @@
+#pragma once
+#include "balanced_tree_bag.hpp"
+#include "searchable_bag.hpp"
+#include "bag_tree_search.hpp"
+#include <utility>
+
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T> >
+class basic_searchable_balanced_tree_bag : public basic_balanced_tree_bag<T, Compare, Alloc>, public basic_searchable_bag<T> {
+
+	typedef basic_balanced_tree_bag<T, Compare, Alloc> tree_base;
+	typedef typename tree_base::node node;
+
+	public:
+	basic_searchable_balanced_tree_bag() : tree_base() {}
+	basic_searchable_balanced_tree_bag(const basic_searchable_balanced_tree_bag &other) : tree_base(other) {}
+	basic_searchable_balanced_tree_bag& operator=(const basic_searchable_balanced_tree_bag &other) {
+		if (this != &other)
+			tree_base::operator=(other);
+		return *this;
+	}
+	basic_searchable_balanced_tree_bag(basic_searchable_balanced_tree_bag &&other) noexcept : tree_base(std::move(other)) {}
+	basic_searchable_balanced_tree_bag &operator=(basic_searchable_balanced_tree_bag &&other) noexcept {
+		tree_base::operator=(std::move(other));
+		return *this;
+	}
+	~basic_searchable_balanced_tree_bag() {}
+
+	void swap(basic_searchable_balanced_tree_bag &other) noexcept {
+		tree_base::swap(other);
+	}
+
+	using basic_searchable_bag<T>::insert_unique;
+	bool insert_unique(T item) {
+		return this->try_insert(item);
+	}
+
+	bool erase(T item) {
+		return this->try_erase(item);
+	}
+
+	// Both comparisons are made before either is tested: with a
+	// short-circuit the direction becomes a branch that mispredicts on
+	// every other level, instead of a conditional move.
+	bool has(T item) const {
+		node *current = this->tree;
+		while (current) {
+			bool right = this->comp(current->value, item);
+			bool left = this->comp(item, current->value);
+			if (!(left | right))
+				return true;
+			current = right ? current->r : current->l;
+		}
+		return false;
+	}
+
+	void has_batch(const T *keys, int n, bool *out) const {
+		tree_has_batch(this->tree, this->comp, keys, n, out);
+	}
+};
+
+extern template class basic_searchable_balanced_tree_bag<int>;
+typedef basic_searchable_balanced_tree_bag<int> searchable_balanced_tree_bag;
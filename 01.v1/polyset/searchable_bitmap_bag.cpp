@@ -0,0 +1,808 @@
+#include "searchable_bitmap_bag.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+// Without the popcnt instruction the builtin is a libgcc call; the inline
+// bit-slice count is several times faster than that.
+static inline int popcount64(uint64_t w) {
+#if defined(__GNUC__) && defined(__POPCNT__)
+	return __builtin_popcountll(w);
+#else
+	w = w - ((w >> 1) & 0x5555555555555555ull);
+	w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+	w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return (int)((w * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+static inline int lowest_bit64(uint64_t w) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(w);
+#else
+	int i = 0;
+	while (!(w & 1u)) {
+		w >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
+
+static int runs_in(const uint16_t *values, size_t count) {
+	if (count == 0)
+		return 0;
+	int runs = 1;
+	for (size_t i = 1; i < count; i++)
+		if (values[i] != values[i - 1] + 1)
+			runs++;
+	return runs;
+}
+
+uint32_t searchable_bitmap_bag::to_key(int item) {
+	return (uint32_t)item ^ 0x80000000u;
+}
+
+int searchable_bitmap_bag::from_key(uint32_t key) {
+	return (int)(key ^ 0x80000000u);
+}
+
+// Branchless narrowing to a window of at most 17 values that must hold low
+// if it is present, then an SSE2 compare of 8 values at a time.
+bool searchable_bitmap_bag::array_has(const container &c, uint16_t low) {
+	const uint16_t *v = c.values.data();
+	const uint16_t *end = v + c.values.size();
+	size_t len = c.values.size();
+	while (len > 16) {
+		size_t half = len / 2;
+		v = (v[half] < low) ? v + half : v;
+		len -= half;
+	}
+	const uint16_t *stop = std::min(v + len + 1, end);
+#ifdef __SSE2__
+	__m128i needle = _mm_set1_epi16((short)low);
+	for (; v + 8 <= stop; v += 8) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(chunk, needle)))
+			return true;
+	}
+#endif
+	for (; v < stop; v++)
+		if (*v == low)
+			return true;
+	return false;
+}
+
+bool searchable_bitmap_bag::run_has(const container &c, uint16_t low) {
+	const uint16_t *v = c.values.data();
+	int lo = 0;
+	int hi = (int)c.values.size() / 2;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (v[2 * mid] <= low)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == 0)
+		return false;
+	return low - v[2 * (lo - 1)] <= v[2 * (lo - 1) + 1];
+}
+
+bool searchable_bitmap_bag::container_has(const container &c, uint16_t low) {
+	switch (c.type) {
+		case ARRAY:
+			return array_has(c, low);
+		case BITMAP:
+			return (c.bits[low >> 6] >> (low & 63)) & 1;
+		default:
+			return run_has(c, low);
+	}
+}
+
+bool searchable_bitmap_bag::container_insert(container &c, uint16_t low) {
+	if (c.type == ARRAY) {
+		std::vector<uint16_t>::iterator it = std::lower_bound(c.values.begin(), c.values.end(), low);
+		if (it != c.values.end() && *it == low)
+			return false;
+		c.values.insert(it, low);
+		c.cardinality++;
+		if (c.cardinality > ARRAY_MAX) {
+			std::vector<uint16_t> sorted;
+			sorted.swap(c.values);
+			store(c, sorted, runs_in(sorted.data(), sorted.size()));
+		}
+	} else if (c.type == BITMAP) {
+		uint64_t bit = (uint64_t)1 << (low & 63);
+		if (c.bits[low >> 6] & bit)
+			return false;
+		c.bits[low >> 6] |= bit;
+		c.cardinality++;
+	} else {
+		if (run_has(c, low))
+			return false;
+		std::vector<uint16_t> &v = c.values;
+		int runs = (int)v.size() / 2;
+		int next = 0;
+		while (next < runs && v[2 * next] <= low)
+			next++;
+		int prev = next - 1;
+		bool extend_prev = prev >= 0 && v[2 * prev] + v[2 * prev + 1] + 1 == low;
+		bool join_next = next < runs && v[2 * next] == low + 1;
+		if (extend_prev && join_next) {
+			v[2 * prev + 1] = (uint16_t)(v[2 * next] + v[2 * next + 1] - v[2 * prev]);
+			v.erase(v.begin() + 2 * next, v.begin() + 2 * next + 2);
+		} else if (extend_prev) {
+			v[2 * prev + 1]++;
+		} else if (join_next) {
+			v[2 * next] = low;
+			v[2 * next + 1]++;
+		} else {
+			uint16_t run[2] = { low, 0 };
+			v.insert(v.begin() + 2 * next, run, run + 2);
+		}
+		c.cardinality++;
+		runs = (int)v.size() / 2;
+		if (best_kind(c.cardinality, runs) != RUN) {
+			std::vector<uint16_t> sorted;
+			decode(c, sorted);
+			store(c, sorted, runs);
+		}
+	}
+	return true;
+}
+
+bool searchable_bitmap_bag::container_erase(container &c, uint16_t low) {
+	if (c.type == ARRAY) {
+		std::vector<uint16_t>::iterator it = std::lower_bound(c.values.begin(), c.values.end(), low);
+		if (it == c.values.end() || *it != low)
+			return false;
+		c.values.erase(it);
+		c.cardinality--;
+	} else if (c.type == BITMAP) {
+		uint64_t bit = (uint64_t)1 << (low & 63);
+		if (!(c.bits[low >> 6] & bit))
+			return false;
+		c.bits[low >> 6] &= ~bit;
+		c.cardinality--;
+		if (c.cardinality <= ARRAY_MAX)
+			optimize(c);
+	} else {
+		if (!run_has(c, low))
+			return false;
+		std::vector<uint16_t> &v = c.values;
+		int i = 0;
+		while (2 * (i + 1) < (int)v.size() && v[2 * (i + 1)] <= low)
+			i++;
+		uint16_t start = v[2 * i];
+		uint16_t last = (uint16_t)(start + v[2 * i + 1]);
+		if (start == last) {
+			v.erase(v.begin() + 2 * i, v.begin() + 2 * i + 2);
+		} else if (low == start) {
+			v[2 * i]++;
+			v[2 * i + 1]--;
+		} else if (low == last) {
+			v[2 * i + 1]--;
+		} else {
+			uint16_t right[2] = { (uint16_t)(low + 1), (uint16_t)(last - low - 1) };
+			v[2 * i + 1] = (uint16_t)(low - start - 1);
+			v.insert(v.begin() + 2 * i + 2, right, right + 2);
+		}
+		c.cardinality--;
+		int runs = (int)v.size() / 2;
+		if (c.cardinality > 0 && best_kind(c.cardinality, runs) != RUN) {
+			std::vector<uint16_t> sorted;
+			decode(c, sorted);
+			store(c, sorted, runs);
+		}
+	}
+	return true;
+}
+
+// lows must be sorted and unique.
+void searchable_bitmap_bag::container_merge(container &c, const std::vector<uint16_t> &lows) {
+	if (c.type == BITMAP) {
+		for (size_t i = 0; i < lows.size(); i++) {
+			uint64_t &word = c.bits[lows[i] >> 6];
+			uint64_t bit = (uint64_t)1 << (lows[i] & 63);
+			c.cardinality += !(word & bit);
+			word |= bit;
+		}
+		optimize(c);
+		return;
+	}
+	std::vector<uint16_t> current;
+	decode(c, current);
+	std::vector<uint16_t> merged;
+	merged.reserve(current.size() + lows.size());
+	std::set_union(current.begin(), current.end(), lows.begin(), lows.end(),
+		std::back_inserter(merged));
+	store(c, merged, runs_in(merged.data(), merged.size()));
+}
+
+// A run starts at every set bit whose lower neighbour, possibly the top bit
+// of the previous word, is clear.
+int searchable_bitmap_bag::container_rank(const container &c, uint16_t low) {
+	if (c.type == ARRAY)
+		return (int)(std::lower_bound(c.values.begin(), c.values.end(), low) - c.values.begin());
+	int count = 0;
+	if (c.type == BITMAP) {
+		// Counts from the nearer end: at most half the words.
+		int w = low >> 6;
+		uint64_t below = (1ull << (low & 63)) - 1;
+		if (w < BITMAP_WORDS / 2) {
+			for (int i = 0; i < w; i++)
+				count += popcount64(c.bits[i]);
+			return count + popcount64(c.bits[w] & below);
+		}
+		for (int i = w + 1; i < BITMAP_WORDS; i++)
+			count += popcount64(c.bits[i]);
+		return c.cardinality - count - popcount64(c.bits[w] & ~below);
+	}
+	for (size_t r = 0; r < c.values.size() && c.values[r] < low; r += 2) {
+		int end = c.values[r] + c.values[r + 1] + 1;
+		count += std::min(end, (int)low) - c.values[r];
+	}
+	return count;
+}
+
+uint16_t searchable_bitmap_bag::container_select(const container &c, int k) {
+	if (c.type == ARRAY)
+		return c.values[k];
+	if (c.type == BITMAP) {
+		// Walks from the nearer end, like container_rank().
+		int w = 0;
+		if (2 * k < c.cardinality) {
+			for (; k >= popcount64(c.bits[w]); w++)
+				k -= popcount64(c.bits[w]);
+		} else {
+			int above = c.cardinality - 1 - k;	// values after the one wanted
+			for (w = BITMAP_WORDS - 1; above >= popcount64(c.bits[w]); w--)
+				above -= popcount64(c.bits[w]);
+			k = popcount64(c.bits[w]) - 1 - above;
+		}
+		uint64_t word = c.bits[w];
+		for (; k > 0; k--)
+			word &= word - 1;
+		return (uint16_t)(w * 64 + lowest_bit64(word));
+	}
+	size_t r = 0;
+	for (; k > c.values[r + 1]; r += 2)
+		k -= c.values[r + 1] + 1;
+	return (uint16_t)(c.values[r] + k);
+}
+
+int searchable_bitmap_bag::count_runs(const container &c) {
+	if (c.type == ARRAY)
+		return runs_in(c.values.data(), c.values.size());
+	if (c.type == RUN)
+		return (int)c.values.size() / 2;
+	return runs_in_words(c.bits.data());
+}
+
+int searchable_bitmap_bag::runs_in_words(const uint64_t *words) {
+	int runs = 0;
+	uint64_t carry = 0;
+	for (int i = 0; i < BITMAP_WORDS; i++) {
+		uint64_t w = words[i];
+		runs += popcount64(w & ~((w << 1) | carry));
+		carry = w >> 63;
+	}
+	return runs;
+}
+
+// Sizes in bytes: 2 per array value, 8192 per bitmap, 4 per run.
+searchable_bitmap_bag::kind searchable_bitmap_bag::best_kind(int cardinality, int runs) {
+	int array_bytes = cardinality <= ARRAY_MAX ? 2 * cardinality : 2 * BITMAP_WORDS * 8;
+	if (4 * runs < std::min(array_bytes, BITMAP_WORDS * 8))
+		return RUN;
+	return cardinality <= ARRAY_MAX ? ARRAY : BITMAP;
+}
+
+void searchable_bitmap_bag::decode(const container &c, std::vector<uint16_t> &out) {
+	out.clear();
+	if (c.type == ARRAY) {
+		out = c.values;
+	} else if (c.type == RUN) {
+		out.reserve(c.cardinality);
+		for (size_t i = 0; i < c.values.size(); i += 2)
+			for (int v = c.values[i]; v <= c.values[i] + c.values[i + 1]; v++)
+				out.push_back((uint16_t)v);
+	} else {
+		out.reserve(c.cardinality);
+		for (int i = 0; i < BITMAP_WORDS; i++)
+			for (uint64_t w = c.bits[i]; w; w &= w - 1)
+				out.push_back((uint16_t)(i * 64 + lowest_bit64(w)));
+	}
+}
+
+void searchable_bitmap_bag::store(container &c, const std::vector<uint16_t> &sorted, int runs) {
+	c.type = best_kind((int)sorted.size(), runs);
+	c.cardinality = (int)sorted.size();
+	std::vector<uint16_t>().swap(c.values);
+	std::vector<uint64_t>().swap(c.bits);
+	if (c.type == ARRAY) {
+		c.values = sorted;
+	} else if (c.type == BITMAP) {
+		c.bits.assign(BITMAP_WORDS, 0);
+		for (size_t i = 0; i < sorted.size(); i++)
+			c.bits[sorted[i] >> 6] |= (uint64_t)1 << (sorted[i] & 63);
+	} else {
+		c.values.reserve(2 * runs);
+		for (size_t i = 0; i < sorted.size(); ) {
+			size_t j = i + 1;
+			while (j < sorted.size() && sorted[j] == sorted[j - 1] + 1)
+				j++;
+			c.values.push_back(sorted[i]);
+			c.values.push_back((uint16_t)(j - i - 1));
+			i = j;
+		}
+	}
+}
+
+void searchable_bitmap_bag::optimize(container &c) {
+	int runs = count_runs(c);
+	if (best_kind(c.cardinality, runs) == c.type)
+		return;
+	std::vector<uint16_t> sorted;
+	decode(c, sorted);
+	store(c, sorted, runs);
+}
+
+void searchable_bitmap_bag::to_words(const container &c, uint64_t *words) {
+	if (c.type == BITMAP) {
+		std::copy(c.bits.begin(), c.bits.end(), words);
+		return;
+	}
+	std::fill(words, words + BITMAP_WORDS, 0);
+	if (c.type == ARRAY) {
+		for (size_t i = 0; i < c.values.size(); i++)
+			words[c.values[i] >> 6] |= (uint64_t)1 << (c.values[i] & 63);
+		return;
+	}
+	for (size_t i = 0; i < c.values.size(); i += 2)
+		for (int v = c.values[i]; v <= c.values[i] + c.values[i + 1]; v++)
+			words[v >> 6] |= (uint64_t)1 << (v & 63);
+}
+
+void searchable_bitmap_bag::from_words(container &c, const uint64_t *words) {
+	int cardinality = 0;
+	for (int i = 0; i < BITMAP_WORDS; i++)
+		cardinality += popcount64(words[i]);
+	int runs = runs_in_words(words);
+	if (best_kind(cardinality, runs) == BITMAP) {
+		c.type = BITMAP;
+		c.cardinality = cardinality;
+		std::vector<uint16_t>().swap(c.values);
+		c.bits.assign(words, words + BITMAP_WORDS);
+		return;
+	}
+	std::vector<uint16_t> sorted;
+	sorted.reserve(cardinality);
+	for (int i = 0; i < BITMAP_WORDS; i++)
+		for (uint64_t w = words[i]; w; w &= w - 1)
+			sorted.push_back((uint16_t)(i * 64 + lowest_bit64(w)));
+	store(c, sorted, runs);
+}
+
+// Containers present on one side only are copied (OR, and the left side of
+// ANDNOT) or dropped; the result is built aside so out may alias a or b.
+void searchable_bitmap_bag::combine(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		word_op op, searchable_bitmap_bag &out) {
+	std::vector<uint16_t> keys;
+	std::vector<container> containers;
+	std::vector<uint64_t> left(BITMAP_WORDS);
+	std::vector<uint64_t> right(BITMAP_WORDS);
+	size_t i = 0;
+	size_t j = 0;
+	while (i < a.keys.size() || j < b.keys.size()) {
+		bool take_a = j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j]);
+		bool take_b = i == a.keys.size() || (j < b.keys.size() && b.keys[j] < a.keys[i]);
+		if (take_a) {
+			if (op != OP_AND) {
+				keys.push_back(a.keys[i]);
+				containers.push_back(a.containers[i]);
+			}
+			i++;
+			continue;
+		}
+		if (take_b) {
+			if (op == OP_OR) {
+				keys.push_back(b.keys[j]);
+				containers.push_back(b.containers[j]);
+			}
+			j++;
+			continue;
+		}
+		to_words(a.containers[i], left.data());
+		to_words(b.containers[j], right.data());
+		uint64_t *l = left.data();
+		const uint64_t *r = right.data();
+		int w = 0;
+#ifdef __SSE2__
+		for (; w + 2 <= BITMAP_WORDS; w += 2) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l + w));
+			__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + w));
+			__m128i z = op == OP_OR ? _mm_or_si128(x, y)
+				: op == OP_AND ? _mm_and_si128(x, y)
+				: _mm_andnot_si128(y, x);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(l + w), z);
+		}
+#endif
+		for (; w < BITMAP_WORDS; w++)
+			l[w] = op == OP_OR ? (l[w] | r[w]) : op == OP_AND ? (l[w] & r[w]) : (l[w] & ~r[w]);
+		container c;
+		from_words(c, l);
+		if (c.cardinality > 0) {
+			keys.push_back(a.keys[i]);
+			containers.push_back(c);
+		}
+		i++;
+		j++;
+	}
+	out.keys.swap(keys);
+	out.containers.swap(containers);
+	out.rebuild_card_sums();
+}
+
+void searchable_bitmap_bag::union_of(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		searchable_bitmap_bag &out) {
+	combine(a, b, OP_OR, out);
+}
+
+void searchable_bitmap_bag::intersection_of(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		searchable_bitmap_bag &out) {
+	combine(a, b, OP_AND, out);
+}
+
+void searchable_bitmap_bag::difference_of(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		searchable_bitmap_bag &out) {
+	combine(a, b, OP_ANDNOT, out);
+}
+
+bool searchable_bitmap_bag::is_subset_of(const searchable_bitmap_bag &other) const {
+	std::vector<uint64_t> mine(BITMAP_WORDS);
+	std::vector<uint64_t> theirs(BITMAP_WORDS);
+	for (size_t i = 0; i < keys.size(); i++) {
+		int j = other.find_container(keys[i]);
+		if (j < 0)
+			return false;
+		if (containers[i].cardinality > other.containers[j].cardinality)
+			return false;
+		to_words(containers[i], mine.data());
+		to_words(other.containers[j], theirs.data());
+		for (int w = 0; w < BITMAP_WORDS; w++)
+			if (mine[w] & ~theirs[w])
+				return false;
+	}
+	return true;
+}
+
+int searchable_bitmap_bag::find_container(uint16_t high) const {
+	std::vector<uint16_t>::const_iterator it = std::lower_bound(keys.begin(), keys.end(), high);
+	if (it == keys.end() || *it != high)
+		return -1;
+	return (int)(it - keys.begin());
+}
+
+searchable_bitmap_bag::container &searchable_bitmap_bag::get_or_create(uint16_t high) {
+	std::vector<uint16_t>::iterator it = std::lower_bound(keys.begin(), keys.end(), high);
+	size_t pos = it - keys.begin();
+	if (it == keys.end() || *it != high) {
+		keys.insert(it, high);
+		container c;
+		c.type = ARRAY;
+		c.cardinality = 0;
+		containers.insert(containers.begin() + pos, c);
+	}
+	return containers[pos];
+}
+
+void searchable_bitmap_bag::rebuild_card_sums() {
+	int n = (int)containers.size();
+	card_sums.assign(n + 1, 0);
+	for (int i = 1; i <= n; i++) {
+		card_sums[i] += containers[i - 1].cardinality;
+		int parent = i + (i & -i);
+		if (parent <= n)
+			card_sums[parent] += card_sums[i];
+	}
+}
+
+void searchable_bitmap_bag::add_cardinality(int i, int delta) {
+	for (int j = i + 1; j < (int)card_sums.size(); j += j & -j)
+		card_sums[j] += delta;
+}
+
+long long searchable_bitmap_bag::cardinality_before(int i) const {
+	long long total = 0;
+	for (int j = i; j > 0; j -= j & -j)
+		total += card_sums[j];
+	return total;
+}
+
+int searchable_bitmap_bag::container_at(long long &k) const {
+	int n = (int)containers.size();
+	int pos = 0;
+	int step = 1;
+	while (step * 2 <= n)
+		step *= 2;
+	for (; step; step /= 2)
+		if (pos + step <= n && card_sums[pos + step] <= k) {
+			pos += step;
+			k -= card_sums[pos];
+		}
+	return pos;
+}
+
+searchable_bitmap_bag::searchable_bitmap_bag() {}
+
+searchable_bitmap_bag::searchable_bitmap_bag(const searchable_bitmap_bag &other)
+	: keys(other.keys), containers(other.containers), card_sums(other.card_sums) {}
+
+searchable_bitmap_bag::searchable_bitmap_bag(searchable_bitmap_bag &&other) noexcept {
+	swap(other);
+}
+
+searchable_bitmap_bag &searchable_bitmap_bag::operator=(const searchable_bitmap_bag &other) {
+	if (this != &other) {
+		keys = other.keys;
+		containers = other.containers;
+		card_sums = other.card_sums;
+	}
+	return *this;
+}
+
+searchable_bitmap_bag &searchable_bitmap_bag::operator=(searchable_bitmap_bag &&other) noexcept {
+	if (this != &other) {
+		clear();
+		swap(other);
+	}
+	return *this;
+}
+
+searchable_bitmap_bag::~searchable_bitmap_bag() {}
+
+void searchable_bitmap_bag::swap(searchable_bitmap_bag &other) noexcept {
+	keys.swap(other.keys);
+	containers.swap(other.containers);
+	card_sums.swap(other.card_sums);
+}
+
+void searchable_bitmap_bag::insert(int item) {
+	insert_unique(item);
+}
+
+bool searchable_bitmap_bag::insert_unique(int item) {
+	uint32_t key = to_key(item);
+	size_t before = containers.size();
+	container &c = get_or_create((uint16_t)(key >> 16));
+	if (!container_insert(c, (uint16_t)key))
+		return false;
+	if (containers.size() != before)
+		rebuild_card_sums();
+	else
+		add_cardinality((int)(&c - containers.data()), 1);
+	return true;
+}
+
+int searchable_bitmap_bag::insert_unique(int *items, int count) {
+	long long before = cardinality();
+	insert(items, count);
+	return (int)(cardinality() - before);
+}
+
+// Sorts the batch once, then merges each run of equal high halves into its
+// container in one pass.
+void searchable_bitmap_bag::insert(int *items, int count) {
+	if (count <= 0)
+		return;
+	std::vector<uint32_t> batch(count);
+	for (int i = 0; i < count; i++)
+		batch[i] = to_key(items[i]);
+	std::sort(batch.begin(), batch.end());
+	batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+	std::vector<uint16_t> lows;
+	size_t before = containers.size();
+	for (size_t i = 0; i < batch.size(); ) {
+		uint16_t high = (uint16_t)(batch[i] >> 16);
+		lows.clear();
+		for (; i < batch.size() && (batch[i] >> 16) == high; i++)
+			lows.push_back((uint16_t)batch[i]);
+		container &c = get_or_create(high);
+		int added = c.cardinality;
+		container_merge(c, lows);
+		added = c.cardinality - added;
+		if (containers.size() == before)
+			add_cardinality((int)(&c - containers.data()), added);
+	}
+	if (containers.size() != before)
+		rebuild_card_sums();
+}
+
+void searchable_bitmap_bag::print() const {
+	std::vector<uint16_t> lows;
+	for (size_t i = 0; i < containers.size(); i++) {
+		decode(containers[i], lows);
+		for (size_t j = 0; j < lows.size(); j++)
+			std::cout << from_key(((uint32_t)keys[i] << 16) | lows[j]) << " ";
+	}
+	std::cout << std::endl;
+}
+
+void searchable_bitmap_bag::collect(std::vector<int> &out) const {
+	std::vector<uint16_t> lows;
+	for (size_t i = 0; i < containers.size(); i++) {
+		decode(containers[i], lows);
+		for (size_t j = 0; j < lows.size(); j++)
+			out.push_back(from_key(((uint32_t)keys[i] << 16) | lows[j]));
+	}
+}
+
+void searchable_bitmap_bag::clear() {
+	std::vector<uint16_t>().swap(keys);
+	std::vector<container>().swap(containers);
+	std::vector<long long>().swap(card_sums);
+}
+
+bool searchable_bitmap_bag::has(int item) const {
+	uint32_t key = to_key(item);
+	int i = find_container((uint16_t)(key >> 16));
+	return i >= 0 && container_has(containers[i], (uint16_t)key);
+}
+
+bool searchable_bitmap_bag::erase(int item) {
+	uint32_t key = to_key(item);
+	int i = find_container((uint16_t)(key >> 16));
+	if (i < 0 || !container_erase(containers[i], (uint16_t)key))
+		return false;
+	if (containers[i].cardinality == 0) {
+		keys.erase(keys.begin() + i);
+		containers.erase(containers.begin() + i);
+		rebuild_card_sums();
+	} else {
+		add_cardinality(i, -1);
+	}
+	return true;
+}
+
+void searchable_bitmap_bag::cursor::set(int low) {
+	current = from_key(((uint32_t)bag->keys[ci] << 16) | (uint32_t)low);
+}
+
+void searchable_bitmap_bag::cursor::enter() {
+	pos = 0;
+	off = 0;
+	word = 0;
+	for (; ci < bag->containers.size(); ci++) {
+		const container &c = bag->containers[ci];
+		if (c.type != BITMAP) {
+			if (!c.values.empty()) {
+				set(c.values[0]);
+				return;
+			}
+			continue;
+		}
+		for (pos = 0; pos < BITMAP_WORDS; pos++) {
+			if (c.bits[pos]) {
+				word = c.bits[pos];
+				set(pos * 64 + lowest_bit64(word));
+				return;
+			}
+		}
+		pos = 0;
+	}
+	current = 0;
+}
+
+void searchable_bitmap_bag::cursor::next() {
+	const container &c = bag->containers[ci];
+	if (c.type == ARRAY) {
+		if (++pos < (int)c.values.size()) {
+			set(c.values[pos]);
+			return;
+		}
+	} else if (c.type == RUN) {
+		if (off < c.values[pos + 1]) {
+			set(c.values[pos] + ++off);
+			return;
+		}
+		pos += 2;
+		off = 0;
+		if (pos < (int)c.values.size()) {
+			set(c.values[pos]);
+			return;
+		}
+	} else {
+		word &= word - 1;
+		while (!word && ++pos < BITMAP_WORDS)
+			word = c.bits[pos];
+		if (word) {
+			set(pos * 64 + lowest_bit64(word));
+			return;
+		}
+	}
+	ci++;
+	enter();
+}
+
+searchable_bitmap_bag::const_iterator searchable_bitmap_bag::begin() const {
+	cursor c = { this, 0, 0, 0, 0, 0 };
+	c.enter();
+	return const_iterator(c);
+}
+
+searchable_bitmap_bag::const_iterator searchable_bitmap_bag::end() const {
+	cursor c = { this, containers.size(), 0, 0, 0, 0 };
+	return const_iterator(c);
+}
+
+long long searchable_bitmap_bag::cardinality() const {
+	return cardinality_before((int)containers.size());
+}
+
+long long searchable_bitmap_bag::rank(int item) const {
+	uint32_t key = to_key(item);
+	uint16_t high = (uint16_t)(key >> 16);
+	int i = (int)(std::lower_bound(keys.begin(), keys.end(), high) - keys.begin());
+	long long count = cardinality_before(i);
+	if (i < (int)keys.size() && keys[i] == high)
+		count += container_rank(containers[i], (uint16_t)key);
+	return count;
+}
+
+bool searchable_bitmap_bag::select(long long k, int &out) const {
+	if (k < 0 || k >= cardinality())
+		return false;
+	int i = container_at(k);
+	out = from_key(((uint32_t)keys[i] << 16) | container_select(containers[i], (int)k));
+	return true;
+}
+
+long long searchable_bitmap_bag::count_range(int low, int high) const {
+	if (low > high)
+		return 0;
+	return rank(high) + has(high) - rank(low);
+}
+
+bool searchable_bitmap_bag::lower_bound(int item, int &out) const {
+	return select(rank(item), out);
+}
+
+bool searchable_bitmap_bag::upper_bound(int item, int &out) const {
+	return select(rank(item) + has(item), out);
+}
+
+size_t searchable_bitmap_bag::memory_usage() const {
+	size_t bytes = sizeof(*this)
+		+ keys.capacity() * sizeof(uint16_t)
+		+ containers.capacity() * sizeof(container);
+	for (size_t i = 0; i < containers.size(); i++)
+		bytes += containers[i].values.capacity() * sizeof(uint16_t)
+			+ containers[i].bits.capacity() * sizeof(uint64_t);
+	return bytes;
+}
+
+void searchable_bitmap_bag::container_counts(int &arrays, int &bitmaps, int &runs) const {
+	arrays = 0;
+	bitmaps = 0;
+	runs = 0;
+	for (size_t i = 0; i < containers.size(); i++) {
+		if (containers[i].type == ARRAY)
+			arrays++;
+		else if (containers[i].type == BITMAP)
+			bitmaps++;
+		else
+			runs++;
+	}
+}
+
+void searchable_bitmap_bag::run_optimize() {
+	for (size_t i = 0; i < containers.size(); i++)
+		optimize(containers[i]);
+}
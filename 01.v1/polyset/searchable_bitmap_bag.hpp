@@ -0,0 +1,160 @@
+#pragma once
+#include "searchable_bag.hpp"
+#include "bag_iterator.hpp"
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+// Compressed bitmap set of ints in the Roaring layout. Values are split into
+// a 16-bit high part, which selects a container, and a 16-bit low part stored
+// in that container as one of:
+//   ARRAY  - sorted uint16 values, at most ARRAY_MAX of them
+//   BITMAP - 65536 bits
+//   RUN    - sorted (start, length - 1) pairs
+// Each container uses whichever of the three is smallest after a bulk insert
+// or run_optimize(); single inserts only switch ARRAY to BITMAP when the
+// array fills up, and RUN to the smaller of the other two when the runs stop
+// paying off. erase() works the other way: BITMAP goes back to the smaller
+// form once the array would fit, RUN when the split runs stop paying off,
+// and an emptied container is dropped.
+//
+// Values are stored with the sign bit flipped so that containers, and
+// print(), follow signed order. Duplicates are dropped.
+//
+// A Fenwick tree over the container cardinalities, in directory order, is
+// updated by every insert and erase and rebuilt whenever a container is
+// added or dropped (which already moves the whole directory). It gives the
+// number of values before any container in O(log n) for the order-statistic
+// queries and cardinality().
+class searchable_bitmap_bag : public searchable_bag {
+
+	private:
+	enum kind { ARRAY, BITMAP, RUN };
+	enum word_op { OP_OR, OP_AND, OP_ANDNOT };
+	static const int ARRAY_MAX = 4096;
+	static const int BITMAP_WORDS = 1024;
+
+	struct container {
+		kind type;
+		int cardinality;
+		std::vector<uint16_t> values;	// ARRAY and RUN
+		std::vector<uint64_t> bits;	// BITMAP
+	};
+
+	std::vector<uint16_t> keys;
+	std::vector<container> containers;
+	std::vector<long long> card_sums;	// Fenwick tree over cardinalities, 1-based
+
+	static uint32_t to_key(int item);
+	static int from_key(uint32_t key);
+
+	static bool array_has(const container &c, uint16_t low);
+	static bool run_has(const container &c, uint16_t low);
+	static bool container_has(const container &c, uint16_t low);
+	static bool container_insert(container &c, uint16_t low);
+	static bool container_erase(container &c, uint16_t low);
+	static void container_merge(container &c, const std::vector<uint16_t> &lows);
+	// Values of c less than low, and the value with k smaller ones.
+	static int container_rank(const container &c, uint16_t low);
+	static uint16_t container_select(const container &c, int k);
+	static int count_runs(const container &c);
+	static kind best_kind(int cardinality, int runs);
+	static void decode(const container &c, std::vector<uint16_t> &out);
+	static void store(container &c, const std::vector<uint16_t> &sorted, int runs);
+	static void optimize(container &c);
+	static int runs_in_words(const uint64_t *words);
+	static void to_words(const container &c, uint64_t *words);
+	static void from_words(container &c, const uint64_t *words);
+	static void combine(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		word_op op, searchable_bitmap_bag &out);
+
+	int find_container(uint16_t high) const;
+	container &get_or_create(uint16_t high);
+	void rebuild_card_sums();
+	void add_cardinality(int i, int delta);
+	// Values in the containers before i.
+	long long cardinality_before(int i) const;
+	// Container holding the value with k values before it; k becomes the
+	// rank inside that container.
+	int container_at(long long &k) const;
+
+	// Decodes one container at a time in place: pos is the ARRAY index,
+	// the RUN pair (with off into the run) or the BITMAP word, whose bits
+	// not yet visited are in word. ci is the container count at the end.
+	struct cursor {
+		const searchable_bitmap_bag *bag;
+		size_t ci;
+		int pos;
+		int off;
+		uint64_t word;
+		int current;
+		const int &value() const { return current; }
+		void next();
+		// Starts on container ci, or the first one after it with a value.
+		void enter();
+		void set(int low);
+		bool operator==(const cursor &other) const {
+			return ci == other.ci && pos == other.pos && off == other.off && word == other.word;
+		}
+	};
+
+	public:
+	typedef bag_iterator<cursor, int, std::input_iterator_tag> const_iterator;
+
+	searchable_bitmap_bag();
+	searchable_bitmap_bag(const searchable_bitmap_bag &other);
+	searchable_bitmap_bag(searchable_bitmap_bag &&other) noexcept;
+	searchable_bitmap_bag &operator=(const searchable_bitmap_bag &other);
+	searchable_bitmap_bag &operator=(searchable_bitmap_bag &&other) noexcept;
+	~searchable_bitmap_bag();
+
+	// Exchanges the container directories; no container is copied.
+	void swap(searchable_bitmap_bag &other) noexcept;
+
+	void insert(int);
+	void insert(int *, int);
+	bool insert_unique(int item);
+	int insert_unique(int *items, int count);
+	void print() const;
+	void collect(std::vector<int> &out) const;
+	void clear();
+	bool has(int item) const;
+	bool erase(int item);
+
+	// In signed order. The values are decoded on the way, so each one lives
+	// in the iterator: an input iterator, not a forward one.
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	long long cardinality() const;
+	// Order statistics, each O(log n) over the containers plus one step in
+	// a container: a binary search in an ARRAY, at most 1024 popcounts in a
+	// BITMAP, a walk over the runs of a RUN. Values come back through out,
+	// and the bool is false when there is none.
+	// Number of values less than item.
+	long long rank(int item) const;
+	// The value with k smaller ones, for 0 <= k < cardinality().
+	bool select(long long k, int &out) const;
+	// Number of values in [low, high]; 0 when low > high.
+	long long count_range(int low, int high) const;
+	// Smallest value not less than item, and greater than item.
+	bool lower_bound(int item, int &out) const;
+	bool upper_bound(int item, int &out) const;
+	// Bytes held by the bag, including unused vector capacity.
+	size_t memory_usage() const;
+	// Containers of each kind.
+	void container_counts(int &arrays, int &bitmaps, int &runs) const;
+	// Re-encodes every container in its smallest representation.
+	void run_optimize();
+
+	// Set algebra container by container: containers present on both sides
+	// are expanded to 1024 words and combined word by word. out is
+	// overwritten and may be a or b.
+	static void union_of(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		searchable_bitmap_bag &out);
+	static void intersection_of(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		searchable_bitmap_bag &out);
+	static void difference_of(const searchable_bitmap_bag &a, const searchable_bitmap_bag &b,
+		searchable_bitmap_bag &out);
+	bool is_subset_of(const searchable_bitmap_bag &other) const;
+};
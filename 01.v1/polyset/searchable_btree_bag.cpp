@@ -0,0 +1,3 @@
+#include "searchable_btree_bag.hpp"
+
+template class basic_searchable_btree_bag<int>;
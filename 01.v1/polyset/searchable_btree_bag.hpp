@@ -0,0 +1,86 @@
+#pragma once
+#include "btree_bag.hpp"
+#include "searchable_bag.hpp"
+#include <algorithm>
+#include <utility>
+
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T> >
+class basic_searchable_btree_bag : public basic_btree_bag<T, Compare, Alloc>, public basic_searchable_bag<T> {
+
+	typedef basic_btree_bag<T, Compare, Alloc> tree_base;
+	typedef typename tree_base::node node;
+	typedef typename tree_base::leaf_node leaf_node;
+	typedef typename tree_base::inner_node inner_node;
+
+	public:
+	basic_searchable_btree_bag() : tree_base() {}
+	basic_searchable_btree_bag(const basic_searchable_btree_bag &other) : tree_base(other) {}
+	basic_searchable_btree_bag& operator=(const basic_searchable_btree_bag &other) {
+		if (this != &other)
+			tree_base::operator=(other);
+		return *this;
+	}
+	basic_searchable_btree_bag(basic_searchable_btree_bag &&other) noexcept : tree_base(std::move(other)) {}
+	basic_searchable_btree_bag &operator=(basic_searchable_btree_bag &&other) noexcept {
+		tree_base::operator=(std::move(other));
+		return *this;
+	}
+	~basic_searchable_btree_bag() {}
+
+	void swap(basic_searchable_btree_bag &other) noexcept {
+		tree_base::swap(other);
+	}
+
+	bool insert_unique(T item) {
+		return this->try_insert(item);
+	}
+	// Goes through the bulk path, so a large batch is one merge and rebuild.
+	int insert_unique(T *items, int count) {
+		int before = this->key_count;
+		this->insert(items, count);
+		return this->key_count - before;
+	}
+
+	bool erase(T item) {
+		return this->try_erase(item);
+	}
+
+	bool has(T item) const {
+		if (this->root == nullptr)
+			return false;
+		const leaf_node *l = this->find_leaf(this->root, item);
+		int r = this->leaf_rank(l, item);
+		return r < l->count && this->same(l->keys[r], item);
+	}
+
+	// Every leaf is at the same depth, so up to BATCH_LANES searches descend
+	// in lockstep, one level per round, each lane prefetching its next node.
+	void has_batch(const T *keys, int n, bool *out) const {
+		const int BATCH_LANES = 16;
+		for (int base = 0; base < n; base += BATCH_LANES) {
+			int lanes = std::min(BATCH_LANES, n - base);
+			if (this->root == nullptr) {
+				std::fill(out + base, out + base + lanes, false);
+				continue;
+			}
+			const node *current[BATCH_LANES];
+			for (int i = 0; i < lanes; i++)
+				current[i] = this->root;
+			while (!current[0]->leaf) {
+				for (int i = 0; i < lanes; i++) {
+					const inner_node *in = static_cast<const inner_node *>(current[i]);
+					current[i] = in->children[this->child_index(in, keys[base + i])];
+					tree_base::prefetch_node(current[i]);
+				}
+			}
+			for (int i = 0; i < lanes; i++) {
+				const leaf_node *l = static_cast<const leaf_node *>(current[i]);
+				int r = this->leaf_rank(l, keys[base + i]);
+				out[base + i] = r < l->count && this->same(l->keys[r], keys[base + i]);
+			}
+		}
+	}
+};
+
+extern template class basic_searchable_btree_bag<int>;
+typedef basic_searchable_btree_bag<int> searchable_btree_bag;
@@ -0,0 +1,423 @@
+#include "searchable_hash_bag.hpp"
+#include "bag_prefetch.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+static inline int lowest_bit(unsigned mask) {
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#else
+	int i = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
+
+// Fibonacci multiply, then fold the high half down so both the 7-bit tag
+// (low bits) and the group index (bits 7 and up) see every input bit.
+uint64_t searchable_hash_bag::hash(int item) {
+	uint64_t h = (uint64_t)(uint32_t)item * 0x9E3779B97F4A7C15ull;
+	return h ^ (h >> 32);
+}
+
+// Bit i of the result is set when control byte i equals h2.
+unsigned searchable_hash_bag::match(const group &g, signed char h2) {
+#ifdef __SSE2__
+	__m128i ctrl = _mm_load_si128(reinterpret_cast<const __m128i *>(g.ctrl));
+	return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+	unsigned mask = 0;
+	for (int i = 0; i < GROUP_WIDTH; i++)
+		if (g.ctrl[i] == h2)
+			mask |= 1u << i;
+	return mask;
+#endif
+}
+
+unsigned searchable_hash_bag::match_empty(const group &g) {
+	return match(g, EMPTY);
+}
+
+// EMPTY or DELETED: the sign bits of the control bytes.
+unsigned searchable_hash_bag::match_free(const group &g) {
+#ifdef __SSE2__
+	return (unsigned)_mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(g.ctrl)));
+#else
+	unsigned mask = 0;
+	for (int i = 0; i < GROUP_WIDTH; i++)
+		if (g.ctrl[i] < 0)
+			mask |= 1u << i;
+	return mask;
+#endif
+}
+
+// Groups are visited in triangular order (g, g+1, g+3, g+6, ...), which
+// covers every group of a power-of-two table. A group with an empty slot
+// ends the chain: place() would have used it.
+bool searchable_hash_bag::find_in(const table &t, int item, uint64_t h, size_t first) {
+	signed char h2 = (signed char)(h & 0x7F);
+	size_t g = (size_t)(h >> 7) & t.mask;
+	for (size_t step = 1; ; step++) {
+		const group &grp = t.groups[g];
+		for (unsigned m = g >= first ? match(grp, h2) : 0; m; m &= m - 1)
+			if (grp.slots[lowest_bit(m)] == item)
+				return true;
+		if (match_empty(grp))
+			return false;
+		g = (g + step) & t.mask;
+	}
+}
+
+// Caller knows item is absent; the first free slot of the chain, EMPTY or
+// DELETED, takes it.
+void searchable_hash_bag::place(table &t, int item, uint64_t h) {
+	size_t g = (size_t)(h >> 7) & t.mask;
+	for (size_t step = 1; ; step++) {
+		group &grp = t.groups[g];
+		unsigned m = match_free(grp);
+		if (m) {
+			int i = lowest_bit(m);
+			if (grp.ctrl[i] == DELETED)
+				t.deleted--;
+			grp.ctrl[i] = (signed char)(h & 0x7F);
+			grp.slots[i] = item;
+			t.size++;
+			return;
+		}
+		g = (g + step) & t.mask;
+	}
+}
+
+void searchable_hash_bag::alloc_table(table &t, size_t group_count) {
+	t.groups = new group[group_count];
+	t.mask = group_count - 1;
+	t.size = 0;
+	t.deleted = 0;
+	for (size_t g = 0; g < group_count; g++)
+		std::memset(t.groups[g].ctrl, EMPTY, GROUP_WIDTH);
+}
+
+void searchable_hash_bag::free_table(table &t) {
+	delete[] t.groups;
+	t.groups = nullptr;
+	t.mask = 0;
+	t.size = 0;
+	t.deleted = 0;
+}
+
+void searchable_hash_bag::copy_table(table &dst, const table &src) {
+	dst.mask = src.mask;
+	dst.size = src.size;
+	dst.deleted = src.deleted;
+	if (!src.groups) {
+		dst.groups = nullptr;
+		return;
+	}
+	dst.groups = new group[src.mask + 1];
+	std::copy(src.groups, src.groups + src.mask + 1, dst.groups);
+}
+
+size_t searchable_hash_bag::limit(const table &t) const {
+	if (!t.groups)
+		return 0;
+	return (size_t)((t.mask + 1) * GROUP_WIDTH * max_load);
+}
+
+size_t searchable_hash_bag::groups_for(size_t count) const {
+	size_t groups = 1;
+	while ((size_t)(groups * GROUP_WIDTH * max_load) < count)
+		groups *= 2;
+	return groups;
+}
+
+// Moves cur aside as the table to drain and allocates a new cur large enough
+// for count elements. Any previous drain must be finished.
+void searchable_hash_bag::start_resize(size_t count) {
+	old = cur;
+	alloc_table(cur, groups_for(count));
+	migrate_pos = 0;
+	if (!old.groups || old.size == 0)
+		free_table(old);
+}
+
+void searchable_hash_bag::migrate_step(size_t group_count) {
+	size_t end = std::min(migrate_pos + group_count, old.mask + 1);
+	for (; migrate_pos < end; migrate_pos++) {
+		const group &grp = old.groups[migrate_pos];
+		for (int i = 0; i < GROUP_WIDTH; i++) {
+			if (grp.ctrl[i] >= 0) {
+				place(cur, grp.slots[i], hash(grp.slots[i]));
+				old.size--;
+			}
+		}
+	}
+	if (migrate_pos > old.mask)
+		free_table(old);
+}
+
+void searchable_hash_bag::finish_migration() {
+	if (old.groups)
+		migrate_step(old.mask + 1);
+}
+
+searchable_hash_bag::searchable_hash_bag() : migrate_pos(0), max_load(0.875f) {
+	cur.groups = nullptr;
+	cur.mask = 0;
+	cur.size = 0;
+	cur.deleted = 0;
+	old = cur;
+}
+
+searchable_hash_bag::searchable_hash_bag(const searchable_hash_bag &other)
+	: migrate_pos(other.migrate_pos), max_load(other.max_load) {
+	copy_table(cur, other.cur);
+	copy_table(old, other.old);
+}
+
+searchable_hash_bag::searchable_hash_bag(searchable_hash_bag &&other) noexcept
+	: migrate_pos(0), max_load(other.max_load) {
+	cur.groups = nullptr;
+	cur.mask = 0;
+	cur.size = 0;
+	cur.deleted = 0;
+	old = cur;
+	swap(other);
+}
+
+searchable_hash_bag &searchable_hash_bag::operator=(const searchable_hash_bag &other) {
+	if (this != &other) {
+		free_table(cur);
+		free_table(old);
+		copy_table(cur, other.cur);
+		copy_table(old, other.old);
+		migrate_pos = other.migrate_pos;
+		max_load = other.max_load;
+	}
+	return *this;
+}
+
+searchable_hash_bag &searchable_hash_bag::operator=(searchable_hash_bag &&other) noexcept {
+	if (this != &other) {
+		clear();
+		swap(other);
+	}
+	return *this;
+}
+
+searchable_hash_bag::~searchable_hash_bag() {
+	free_table(cur);
+	free_table(old);
+}
+
+void searchable_hash_bag::swap(searchable_hash_bag &other) noexcept {
+	std::swap(cur, other.cur);
+	std::swap(old, other.old);
+	std::swap(migrate_pos, other.migrate_pos);
+	std::swap(max_load, other.max_load);
+}
+
+void searchable_hash_bag::insert(int item) {
+	insert_unique(item);
+}
+
+bool searchable_hash_bag::insert_unique(int item) {
+	uint64_t h = hash(item);
+	if (cur.groups && find_in(cur, item, h))
+		return false;
+	if (old.groups && find_in(old, item, h, migrate_pos))
+		return false;
+	if (old.groups)
+		migrate_step(MIGRATE_GROUPS);
+	if (cur.size + cur.deleted + 1 > limit(cur)) {
+		finish_migration();
+		start_resize(std::max(cur.size + 1, 2 * cur.size));
+	}
+	place(cur, item, h);
+	return true;
+}
+
+void searchable_hash_bag::insert(int *items, int count) {
+	insert_unique(items, count);
+}
+
+int searchable_hash_bag::insert_unique(int *items, int count) {
+	if (count <= 0)
+		return 0;
+	reserve(size() + count);
+	int inserted = 0;
+	for (int i = 0; i < count; i++)
+		inserted += insert_unique(items[i]);
+	return inserted;
+}
+
+void searchable_hash_bag::print() const {
+	for (size_t g = 0; cur.groups && g <= cur.mask; g++)
+		for (int i = 0; i < GROUP_WIDTH; i++)
+			if (cur.groups[g].ctrl[i] >= 0)
+				std::cout << cur.groups[g].slots[i] << " ";
+	for (size_t g = migrate_pos; old.groups && g <= old.mask; g++)
+		for (int i = 0; i < GROUP_WIDTH; i++)
+			if (old.groups[g].ctrl[i] >= 0)
+				std::cout << old.groups[g].slots[i] << " ";
+	std::cout << std::endl;
+}
+
+void searchable_hash_bag::collect(std::vector<int> &out) const {
+	for (size_t g = 0; cur.groups && g <= cur.mask; g++)
+		for (int i = 0; i < GROUP_WIDTH; i++)
+			if (cur.groups[g].ctrl[i] >= 0)
+				out.push_back(cur.groups[g].slots[i]);
+	for (size_t g = migrate_pos; old.groups && g <= old.mask; g++)
+		for (int i = 0; i < GROUP_WIDTH; i++)
+			if (old.groups[g].ctrl[i] >= 0)
+				out.push_back(old.groups[g].slots[i]);
+}
+
+const int &searchable_hash_bag::cursor::value() const {
+	return t->groups[g].slots[lowest_bit(left)];
+}
+
+void searchable_hash_bag::cursor::next() {
+	left &= left - 1;
+	if (left == 0) {
+		g++;
+		settle();
+	}
+}
+
+void searchable_hash_bag::cursor::settle() {
+	while (t) {
+		for (; t->groups && g <= t->mask; g++) {
+			left = ~match_free(t->groups[g]) & 0xFFFFu;
+			if (left)
+				return;
+		}
+		if (t == &bag->old) {
+			t = nullptr;
+			g = 0;
+		} else {
+			t = &bag->old;
+			g = bag->migrate_pos;
+		}
+	}
+	left = 0;
+}
+
+searchable_hash_bag::const_iterator searchable_hash_bag::begin() const {
+	cursor c = { this, &cur, 0, 0 };
+	c.settle();
+	return const_iterator(c);
+}
+
+searchable_hash_bag::const_iterator searchable_hash_bag::end() const {
+	cursor c = { this, nullptr, 0, 0 };
+	return const_iterator(c);
+}
+
+void searchable_hash_bag::clear() {
+	free_table(cur);
+	free_table(old);
+	migrate_pos = 0;
+}
+
+// The slot can go straight back to EMPTY when its group has an EMPTY slot:
+// every probe that reaches the group stops there anyway.
+bool searchable_hash_bag::erase_in(table &t, int item, uint64_t h, size_t first) {
+	signed char h2 = (signed char)(h & 0x7F);
+	size_t g = (size_t)(h >> 7) & t.mask;
+	for (size_t step = 1; ; step++) {
+		group &grp = t.groups[g];
+		for (unsigned m = g >= first ? match(grp, h2) : 0; m; m &= m - 1) {
+			int i = lowest_bit(m);
+			if (grp.slots[i] == item) {
+				if (match_empty(grp)) {
+					grp.ctrl[i] = EMPTY;
+				} else {
+					grp.ctrl[i] = DELETED;
+					t.deleted++;
+				}
+				t.size--;
+				return true;
+			}
+		}
+		if (match_empty(grp))
+			return false;
+		g = (g + step) & t.mask;
+	}
+}
+
+bool searchable_hash_bag::erase(int item) {
+	uint64_t h = hash(item);
+	if (cur.groups && erase_in(cur, item, h))
+		return true;
+	return old.groups && erase_in(old, item, h, migrate_pos);
+}
+
+bool searchable_hash_bag::has(int item) const {
+	uint64_t h = hash(item);
+	if (cur.groups && find_in(cur, item, h))
+		return true;
+	return old.groups && find_in(old, item, h, migrate_pos);
+}
+
+// Hashes up to BATCH_LANES keys and prefetches the home group of each
+// before probing any of them, so the first miss of every key overlaps.
+void searchable_hash_bag::has_batch(const int *keys, int n, bool *out) const {
+	const int BATCH_LANES = 16;
+	uint64_t h[BATCH_LANES];
+	for (int base = 0; base < n; base += BATCH_LANES) {
+		int lanes = std::min(BATCH_LANES, n - base);
+		for (int i = 0; i < lanes; i++) {
+			h[i] = hash(keys[base + i]);
+			if (cur.groups) {
+				const char *g = reinterpret_cast<const char *>(&cur.groups[(size_t)(h[i] >> 7) & cur.mask]);
+				BAG_PREFETCH(g);
+				BAG_PREFETCH(g + 64);
+			}
+		}
+		for (int i = 0; i < lanes; i++) {
+			int item = keys[base + i];
+			out[base + i] = (cur.groups && find_in(cur, item, h[i]))
+				|| (old.groups && find_in(old, item, h[i], migrate_pos));
+		}
+	}
+}
+
+int searchable_hash_bag::size() const {
+	return (int)(cur.size + old.size);
+}
+
+int searchable_hash_bag::capacity() const {
+	return cur.groups ? (int)((cur.mask + 1) * GROUP_WIDTH) : 0;
+}
+
+// Rehashes in one go: the caller asked for the room up front.
+void searchable_hash_bag::reserve(int count) {
+	finish_migration();
+	if (count <= 0 || (size_t)count <= limit(cur))
+		return;
+	start_resize((size_t)count);
+	finish_migration();
+}
+
+float searchable_hash_bag::load_factor() const {
+	int cap = capacity();
+	return cap ? (float)size() / cap : 0.0f;
+}
+
+float searchable_hash_bag::max_load_factor() const {
+	return max_load;
+}
+
+void searchable_hash_bag::max_load_factor(float load) {
+	max_load = std::min(std::max(load, 0.25f), 0.9375f);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "searchable_bag.hpp"
+#include "bag_iterator.hpp"
+#include <cstddef>
+#include <stdint.h>
+
+// Open-addressing hash set of ints in the Swiss-table style: slots are
+// grouped by 16, each group carries one control byte per slot (EMPTY,
+// DELETED or the low 7 bits of the hash) and a lookup compares a whole group
+// of control bytes at once, touching a slot only on a 7-bit match.
+//
+// Duplicates are dropped, like the tree bags. When the load factor would
+// exceed max_load_factor() a table twice the size is allocated and the old
+// one is drained into it a few groups per insert, so no single insert pays
+// for a full rehash; has() looks in both tables until the drain finishes.
+//
+// Probing is by group, so erase() cannot shift later keys back as linear
+// probing does. A slot whose group still has an EMPTY slot becomes EMPTY,
+// since no probe chain runs through such a group; otherwise it becomes a
+// DELETED tombstone, which inserts reuse. Tombstones count toward the load
+// factor, and the resize they trigger, sized for the live keys only, drops
+// them a few groups at a time like any other drain.
+class searchable_hash_bag : public searchable_bag {
+
+	private:
+	static const int GROUP_WIDTH = 16;
+	static const int MIGRATE_GROUPS = 2;
+	// Free slots have negative control bytes.
+	static const signed char EMPTY = -128;
+	static const signed char DELETED = -2;
+
+	struct alignas(16) group {
+		signed char ctrl[GROUP_WIDTH];
+		int slots[GROUP_WIDTH];
+	};
+
+	struct table {
+		group *groups;
+		size_t mask;	// group count - 1, the count is a power of two
+		size_t size;
+		size_t deleted;	// DELETED slots
+	};
+
+	table cur;		// receives every insert
+	table old;		// being drained into cur; groups == nullptr when idle
+	size_t migrate_pos;	// next group of old to drain
+	float max_load;
+
+	static uint64_t hash(int item);
+	static unsigned match(const group &g, signed char h2);
+	static unsigned match_empty(const group &g);
+	static unsigned match_free(const group &g);
+	// Matches in groups below first are ignored: in the table being
+	// drained, those groups have been moved to cur already.
+	static bool find_in(const table &t, int item, uint64_t h, size_t first = 0);
+	static bool erase_in(table &t, int item, uint64_t h, size_t first = 0);
+	static void place(table &t, int item, uint64_t h);
+	static void alloc_table(table &t, size_t group_count);
+	static void free_table(table &t);
+	static void copy_table(table &dst, const table &src);
+
+	size_t limit(const table &t) const;
+	size_t groups_for(size_t count) const;
+	void start_resize(size_t count);
+	void migrate_step(size_t group_count);
+	void finish_migration();
+
+	// Walks cur, then the groups of old not yet drained, as collect() does.
+	// left holds the occupied slots of group g not yet visited, the current
+	// one included; t is nullptr at the end.
+	struct cursor {
+		const searchable_hash_bag *bag;
+		const table *t;
+		size_t g;
+		unsigned left;
+		const int &value() const;
+		void next();
+		// Moves on to the first occupied slot from group g.
+		void settle();
+		bool operator==(const cursor &other) const {
+			return t == other.t && g == other.g && left == other.left;
+		}
+	};
+
+	public:
+	typedef bag_iterator<cursor, int> const_iterator;
+
+	searchable_hash_bag();
+	searchable_hash_bag(const searchable_hash_bag &other);
+	searchable_hash_bag(searchable_hash_bag &&other) noexcept;
+	searchable_hash_bag &operator=(const searchable_hash_bag &other);
+	searchable_hash_bag &operator=(searchable_hash_bag &&other) noexcept;
+	~searchable_hash_bag();
+
+	// Exchanges the tables, including one still being drained.
+	void swap(searchable_hash_bag &other) noexcept;
+
+	void insert(int);
+	void insert(int *, int);
+	bool insert_unique(int item);
+	int insert_unique(int *items, int count);
+	void print() const;
+	void collect(std::vector<int> &out) const;
+	void clear();
+	bool has(int item) const;
+	void has_batch(const int *keys, int n, bool *out) const;
+	bool erase(int item);
+
+	// In table order, which is not sorted; any insert or erase invalidates
+	// the iterators.
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	int size() const;
+	int capacity() const;
+	void reserve(int count);
+	float load_factor() const;
+	float max_load_factor() const;
+	// Clamped to [0.25, 0.9375]; the table always keeps a free slot per
+	// probe chain. A lower value takes effect on the next insert.
+	void max_load_factor(float load);
+};
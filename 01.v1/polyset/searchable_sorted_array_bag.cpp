@@ -0,0 +1,3 @@
+#include "searchable_sorted_array_bag.hpp"
+
+template class basic_searchable_sorted_array_bag<int>;
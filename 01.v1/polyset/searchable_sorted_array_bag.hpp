@@ -0,0 +1,466 @@
+#pragma once
+#include "searchable_bag.hpp"
+#include "array_bag.hpp"
+#include "bag_iterator.hpp"
+#include "bag_prefetch.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// array_bag whose data is kept sorted by Compare, so has() is a binary
+// search and a batch insert is one sort of the batch plus one linear merge.
+// Two values are the same when neither is less than the other. Values are
+// shifted and merged into slots past size as plain assignments, so T must
+// be trivially copyable.
+//
+// erase() leaves a tombstone: the value stays in place, so the array is
+// still sorted for the search, and its slot is flagged dead. An insert
+// shifts values only as far as the nearest dead slot and fills it; a merge
+// compacts the array first, and so does an erase that leaves half the
+// slots dead. Until the first erase there are no flags and no extra check.
+//
+// The order-statistic queries count live copies, repeats included. A
+// Fenwick tree over the dead flags, kept alongside them, gives the number of
+// dead slots before any position in O(log n), so rank() and select() stay
+// O(log n) without compacting.
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T> >
+class basic_searchable_sorted_array_bag : public basic_searchable_bag<T>, public basic_array_bag<T, Alloc> {
+	static_assert(std::is_trivially_copyable<T>::value,
+		"sorted array slots past size are assigned without being constructed");
+
+	typedef basic_array_bag<T, Alloc> array_base;
+
+	private:
+	std::vector<unsigned char> dead;	// one per slot, or empty when none is dead
+	std::vector<int> dead_sums;	// Fenwick tree over dead, 1-based; empty with it
+	int dead_count;
+	Compare comp;
+
+	void set_dead(int i, bool flag);
+	// Live slots before index i.
+	int live_before(int i) const;
+	// Index of the live slot with k live slots before it.
+	int live_index(int k) const;
+
+	struct cursor {
+		const T *data;
+		const unsigned char *dead;	// nullptr when no slot is dead
+		int i;
+		int size;
+		const T &value() const { return data[i]; }
+		void next() {
+			i++;
+			skip_dead();
+		}
+		void skip_dead() {
+			while (dead && i < size && dead[i])
+				i++;
+		}
+		bool operator==(const cursor &other) const { return i == other.i; }
+	};
+
+	public:
+	typedef bag_iterator<cursor, T> const_iterator;
+
+	basic_searchable_sorted_array_bag() : array_base(), dead_count(0) {}
+	basic_searchable_sorted_array_bag(const basic_searchable_sorted_array_bag &other)
+		: array_base(other), dead(other.dead), dead_sums(other.dead_sums),
+		dead_count(other.dead_count), comp(other.comp) {}
+	basic_searchable_sorted_array_bag &operator=(const basic_searchable_sorted_array_bag &other) {
+		if (this != &other) {
+			array_base::operator=(other);
+			dead = other.dead;
+			dead_sums = other.dead_sums;
+			dead_count = other.dead_count;
+			comp = other.comp;
+		}
+		return *this;
+	}
+	basic_searchable_sorted_array_bag(basic_searchable_sorted_array_bag &&other) noexcept
+		: array_base(std::move(other)), dead_count(0), comp(other.comp) {
+		dead.swap(other.dead);
+		dead_sums.swap(other.dead_sums);
+		std::swap(dead_count, other.dead_count);
+	}
+	basic_searchable_sorted_array_bag &operator=(basic_searchable_sorted_array_bag &&other) noexcept {
+		if (this != &other) {
+			clear();
+			swap(other);
+		}
+		return *this;
+	}
+	~basic_searchable_sorted_array_bag() {}
+
+	void swap(basic_searchable_sorted_array_bag &other) noexcept {
+		array_base::swap(other);
+		dead.swap(other.dead);
+		dead_sums.swap(other.dead_sums);
+		std::swap(dead_count, other.dead_count);
+		std::swap(comp, other.comp);
+	}
+
+	void insert(T);
+	void insert(T *, int);
+	bool insert_unique(T item);
+	int insert_unique(T *items, int count);
+	void print() const;
+	void collect(std::vector<T> &out) const;
+	void clear();
+	bool has(T item) const;
+	void has_batch(const T *keys, int n, bool *out) const;
+	bool erase(T item);
+
+	// The live values in sorted order.
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	// Order statistics over the live values, each O(log n). Values come back
+	// through out, and the bool is false when there is none.
+	// Number of values less than item.
+	int rank(T item) const;
+	// The value with k values before it in sorted order.
+	bool select(int k, T &out) const;
+	// Number of values in [low, high]; 0 when low > high.
+	int count_range(T low, T high) const;
+	// Smallest value not less than item, and greater than item.
+	bool lower_bound(T item, T &out) const;
+	bool upper_bound(T item, T &out) const;
+
+	protected:
+	// First slot not less than item, and first slot greater, dead or not.
+	int lower_index(const T &item) const;
+	int upper_index(const T &item) const;
+	// First live copy of item at or after pos, or -1.
+	int find_live(int pos, const T &item) const;
+	void insert_at(int pos, const T &item);
+	void merge(const std::vector<T> &sorted);
+	// Drops the dead slots.
+	void compact();
+};
+
+// Branchless lower bound: the loop always runs log2(size) times and the
+// comparison becomes a conditional move. Both candidate midpoints of the
+// next step are prefetched while the current one is compared.
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::lower_index(const T &item) const {
+	if (this->size == 0)
+		return 0;
+	const T *base = this->data;
+	int len = this->size;
+	while (len > 1) {
+		int half = len / 2;
+		BAG_PREFETCH(base + half / 2);
+		BAG_PREFETCH(base + half + half / 2);
+		base = comp(base[half], item) ? base + half : base;
+		len -= half;
+	}
+	return (int)(base - this->data) + comp(*base, item);
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::upper_index(const T &item) const {
+	return (int)(std::upper_bound(this->data, this->data + this->size, item, comp) - this->data);
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::find_live(int pos, const T &item) const {
+	for (int i = pos; i < this->size && !comp(item, this->data[i]); i++)
+		if (dead.empty() || !dead[i])
+			return i;
+	return -1;
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_searchable_sorted_array_bag<T, Compare, Alloc>::has(T item) const {
+	return find_live(lower_index(item), item) >= 0;
+}
+
+// Runs the branchless search for up to BATCH_LANES keys in lockstep. Every
+// lane takes the same number of steps, so after each step the exact probe
+// of the next one is known and prefetched a whole round ahead.
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::has_batch(const T *keys, int n, bool *out) const {
+	const int BATCH_LANES = 16;
+	const T *data = this->data;
+	int size = this->size;
+	for (int base = 0; base < n; base += BATCH_LANES) {
+		int lanes = std::min(BATCH_LANES, n - base);
+		if (size == 0) {
+			std::fill(out + base, out + base + lanes, false);
+			continue;
+		}
+		const T *pos[BATCH_LANES];
+		for (int i = 0; i < lanes; i++)
+			pos[i] = data;
+		for (int len = size; len > 1; ) {
+			int half = len / 2;
+			len -= half;
+			for (int i = 0; i < lanes; i++) {
+				const T *p = pos[i];
+				p = comp(p[half], keys[base + i]) ? p + half : p;
+				pos[i] = p;
+				BAG_PREFETCH(p + len / 2);
+			}
+		}
+		for (int i = 0; i < lanes; i++) {
+			const T &item = keys[base + i];
+			int idx = (int)(pos[i] - data) + comp(*pos[i], item);
+			out[base + i] = find_live(idx, item) >= 0;
+		}
+	}
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::insert(T item) {
+	insert_at(lower_index(item), item);
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::insert(T *items, int count) {
+	if (count <= 0)
+		return;
+	std::vector<T> batch(items, items + count);
+	std::sort(batch.begin(), batch.end(), comp);
+	merge(batch);
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_searchable_sorted_array_bag<T, Compare, Alloc>::insert_unique(T item) {
+	int pos = lower_index(item);
+	if (find_live(pos, item) >= 0)
+		return false;
+	insert_at(pos, item);
+	return true;
+}
+
+// Sorts and deduplicates the batch, drops what is already stored in one
+// pass alongside the data, and merges the rest.
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::insert_unique(T *items, int count) {
+	if (count <= 0)
+		return 0;
+	std::vector<T> batch(items, items + count);
+	std::sort(batch.begin(), batch.end(), comp);
+	Compare c = comp;
+	batch.erase(std::unique(batch.begin(), batch.end(),
+		[c](const T &a, const T &b) { return !c(a, b); }), batch.end());
+	compact();
+	std::vector<T> fresh;
+	fresh.reserve(batch.size());
+	std::set_difference(batch.begin(), batch.end(), this->data, this->data + this->size,
+		std::back_inserter(fresh), comp);
+	merge(fresh);
+	return (int)fresh.size();
+}
+
+// With dead slots about, only the live values between pos and the nearest
+// dead slot move, one step towards it, and item takes the freed place;
+// everything before pos is smaller than item and nothing from pos on is.
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::insert_at(int pos, const T &item) {
+	T *data = this->data;
+	int size = this->size;
+	if (!dead.empty()) {
+		const unsigned char *flags = dead.data();
+		const void *found = std::memchr(flags + pos, 1, size - pos);
+		int right = found ? (int)(static_cast<const unsigned char *>(found) - flags) : size;
+		// Look left no further than the slot found on the right.
+		int limit = found ? std::max(pos - (right - pos), 0) : 0;
+		int left = pos - 1;
+		while (left >= limit && !flags[left])
+			left--;
+		if (left >= limit) {
+			std::copy(data + left + 1, data + pos, data + left);
+			data[pos - 1] = item;
+			set_dead(left, false);
+		} else {
+			std::copy_backward(data + pos, data + right, data + right + 1);
+			data[pos] = item;
+			set_dead(right, false);
+		}
+		if (--dead_count == 0) {
+			dead.clear();
+			dead_sums.clear();
+		}
+		return;
+	}
+	if (size == this->cap) {
+		this->grow(size + 1);
+		data = this->data;
+	}
+	std::copy_backward(data + pos, data + size, data + size + 1);
+	data[pos] = item;
+	this->size++;
+}
+
+// Merges a sorted batch from the back so the existing elements are moved
+// at most once and no second buffer is needed.
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::merge(const std::vector<T> &batch) {
+	int count = (int)batch.size();
+	if (count == 0)
+		return;
+	compact();
+	if (this->size + count > this->cap)
+		this->grow(this->size + count);
+
+	T *data = this->data;
+	int i = this->size - 1;
+	int j = count - 1;
+	int out = this->size + count - 1;
+	while (j >= 0) {
+		if (i >= 0 && comp(batch[j], data[i]))
+			data[out--] = data[i--];
+		else
+			data[out--] = batch[j--];
+	}
+	this->size += count;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::print() const {
+	if (dead.empty()) {
+		array_base::print();
+		return;
+	}
+	for (int i = 0; i < this->size; i++)
+		if (!dead[i])
+			std::cout << this->data[i] << " ";
+	std::cout << std::endl;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::collect(std::vector<T> &out) const {
+	for (int i = 0; i < this->size; i++)
+		if (dead.empty() || !dead[i])
+			out.push_back(this->data[i]);
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::clear() {
+	array_base::clear();
+	dead.clear();
+	dead_sums.clear();
+	dead_count = 0;
+}
+
+// Compacting once half the slots are dead costs O(n) per n/2 erases.
+template <typename T, typename Compare, typename Alloc>
+bool basic_searchable_sorted_array_bag<T, Compare, Alloc>::erase(T item) {
+	int pos = find_live(lower_index(item), item);
+	if (pos < 0)
+		return false;
+	if (dead.empty()) {
+		dead.assign(this->size, 0);
+		dead_sums.assign(this->size + 1, 0);
+	}
+	set_dead(pos, true);
+	dead_count++;
+	if (2 * dead_count >= this->size)
+		compact();
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::compact() {
+	if (dead.empty())
+		return;
+	int kept = 0;
+	for (int i = 0; i < this->size; i++)
+		if (!dead[i])
+			this->data[kept++] = this->data[i];
+	this->size = kept;
+	dead.clear();
+	dead_sums.clear();
+	dead_count = 0;
+}
+
+template <typename T, typename Compare, typename Alloc>
+void basic_searchable_sorted_array_bag<T, Compare, Alloc>::set_dead(int i, bool flag) {
+	dead[i] = flag;
+	int delta = flag ? 1 : -1;
+	for (int j = i + 1; j <= this->size; j += j & -j)
+		dead_sums[j] += delta;
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::live_before(int i) const {
+	int live = i;
+	if (!dead.empty())
+		for (int j = i; j > 0; j -= j & -j)
+			live -= dead_sums[j];
+	return live;
+}
+
+// Descends the Fenwick tree: the node at pos + step covers step slots, of
+// which step - dead_sums[pos + step] are live.
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::live_index(int k) const {
+	if (dead.empty())
+		return k;
+	int size = this->size;
+	int pos = 0;
+	int wanted = k + 1;
+	int step = 1;
+	while (step * 2 <= size)
+		step *= 2;
+	for (; step; step /= 2) {
+		int next = pos + step;
+		if (next <= size && step - dead_sums[next] < wanted) {
+			wanted -= step - dead_sums[next];
+			pos = next;
+		}
+	}
+	return pos;
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_searchable_sorted_array_bag<T, Compare, Alloc>::const_iterator basic_searchable_sorted_array_bag<T, Compare, Alloc>::begin() const {
+	cursor c = { this->data, dead.empty() ? nullptr : dead.data(), 0, this->size };
+	c.skip_dead();
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc>
+typename basic_searchable_sorted_array_bag<T, Compare, Alloc>::const_iterator basic_searchable_sorted_array_bag<T, Compare, Alloc>::end() const {
+	cursor c = { this->data, nullptr, this->size, this->size };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::rank(T item) const {
+	return live_before(lower_index(item));
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_searchable_sorted_array_bag<T, Compare, Alloc>::select(int k, T &out) const {
+	if (k < 0 || k >= this->size - dead_count)
+		return false;
+	out = this->data[live_index(k)];
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc>
+int basic_searchable_sorted_array_bag<T, Compare, Alloc>::count_range(T low, T high) const {
+	if (comp(high, low))
+		return 0;
+	return live_before(upper_index(high)) - live_before(lower_index(low));
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_searchable_sorted_array_bag<T, Compare, Alloc>::lower_bound(T item, T &out) const {
+	return select(rank(item), out);
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool basic_searchable_sorted_array_bag<T, Compare, Alloc>::upper_bound(T item, T &out) const {
+	return select(live_before(upper_index(item)), out);
+}
+
+extern template class basic_searchable_sorted_array_bag<int>;
+typedef basic_searchable_sorted_array_bag<int> searchable_sorted_array_bag;
@@ -1 +1,3 @@
-#include "searchable_tree_bag.hpp"
\ No newline at end of file
+#include "searchable_tree_bag.hpp"
+
+template class basic_searchable_tree_bag<int>;
@@ -1,29 +1,61 @@
 #pragma once
 #include "tree_bag.hpp"
 #include "searchable_bag.hpp"
+#include "bag_tree_search.hpp"
+#include <utility>
 
-class searchable_tree_bag : public tree_bag, public searchable_bag {
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T>,
+	typename Trace = null_trace>
+class basic_searchable_tree_bag : public basic_tree_bag<T, Compare, Alloc, Trace>, public basic_searchable_bag<T> {
+
+	typedef basic_tree_bag<T, Compare, Alloc, Trace> tree_base;
+	typedef typename tree_base::node node;
 
 	public:
-	searchable_tree_bag() : tree_bag() {}
-	searchable_tree_bag( const searchable_tree_bag &other) : tree_bag(other) {}
-	searchable_tree_bag& operator=(const searchable_tree_bag &other) {
+	basic_searchable_tree_bag() : tree_base() {}
+	basic_searchable_tree_bag( const basic_searchable_tree_bag &other) : tree_base(other) {}
+	basic_searchable_tree_bag& operator=(const basic_searchable_tree_bag &other) {
 		if (this != &other)
-			tree_bag::operator=(other);
+			tree_base::operator=(other);
+		return *this;
+	}
+	basic_searchable_tree_bag(basic_searchable_tree_bag &&other) noexcept : tree_base(std::move(other)) {}
+	basic_searchable_tree_bag &operator=(basic_searchable_tree_bag &&other) noexcept {
+		tree_base::operator=(std::move(other));
 		return *this;
 	}
-	~searchable_tree_bag() {}
+	~basic_searchable_tree_bag() {}
+
+	void swap(basic_searchable_tree_bag &other) noexcept {
+		tree_base::swap(other);
+	}
+
+	using basic_searchable_bag<T>::insert_unique;
+	bool insert_unique(T item) {
+		return this->try_insert(item);
+	}
+
+	bool erase(T item) {
+		return this->try_erase(item);
+	}
 
-	bool has(int item) const {
-		node *current = tree;
+	bool has(T item) const {
+		node *current = this->tree;
 		while (current) {
-			if (item == current->value)
-				return true;
-			else if (item > current->value)
+			if (this->comp(current->value, item))
 				current = current->r;
-			else
+			else if (this->comp(item, current->value))
 				current = current->l;
+			else
+				return true;
 		}
 		return false;
 	}
-};
\ No newline at end of file
+
+	void has_batch(const T *keys, int n, bool *out) const {
+		tree_has_batch(this->tree, this->comp, keys, n, out);
+	}
+};
+
+extern template class basic_searchable_tree_bag<int>;
+typedef basic_searchable_tree_bag<int> searchable_tree_bag;
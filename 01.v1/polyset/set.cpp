@@ -1 +1,157 @@
-#include "set.hpp"
\ No newline at end of file
+#include "set.hpp"
+#include "searchable_bitmap_bag.hpp"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+// Contents of b, sorted and without repeats. Bags that collect in order
+// skip the sort.
+static void sorted_ints(const searchable_bag &b, std::vector<int> &out) {
+	b.collect(out);
+	if (!std::is_sorted(out.begin(), out.end()))
+		std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// Emits the elements of a that are in b (keep_matches) or not in b. Four
+// elements of each side are compared all against all with SSE2 (b rotated
+// three times), and the match bits of the current block of a accumulate
+// until the block is passed. The tail falls back to a scalar merge; an
+// element of the last block with its bit set was already matched.
+static void sorted_match(const std::vector<int> &a, const std::vector<int> &b,
+		bool keep_matches, std::vector<int> &out) {
+	int na = (int)a.size();
+	int nb = (int)b.size();
+	int i = 0;
+	int j = 0;
+	unsigned found = 0;
+#ifdef __SSE2__
+	while (i + 4 <= na && j + 4 <= nb) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&a[i]));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&b[j]));
+		__m128i eq = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi32(va, vb),
+				_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+			_mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+				_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+		found |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(eq));
+		int a_max = a[i + 3];
+		int b_max = b[j + 3];
+		if (a_max <= b_max) {
+			for (int k = 0; k < 4; k++)
+				if (((found >> k) & 1) == (unsigned)keep_matches)
+					out.push_back(a[i + k]);
+			i += 4;
+			found = 0;
+		}
+		if (b_max <= a_max)
+			j += 4;
+	}
+#endif
+	for (int block = i; i < na; i++) {
+		bool present;
+		if (i - block < 4 && ((found >> (i - block)) & 1)) {
+			present = true;
+		} else {
+			while (j < nb && b[j] < a[i])
+				j++;
+			present = j < nb && b[j] == a[i];
+		}
+		if (present == keep_matches)
+			out.push_back(a[i]);
+	}
+}
+
+static void store_result(std::vector<int> &values, searchable_bag &out) {
+	out.clear();
+	if (!values.empty())
+		out.insert_unique(values.data(), (int)values.size());
+}
+
+// Writes a bitmap result into out, by assignment when out is a bitmap bag.
+static void store_result(const searchable_bitmap_bag &result, searchable_bag &out) {
+	searchable_bitmap_bag *bitmap_out = dynamic_cast<searchable_bitmap_bag *>(&out);
+	if (bitmap_out) {
+		*bitmap_out = result;
+		return;
+	}
+	std::vector<int> values;
+	result.collect(values);
+	store_result(values, out);
+}
+
+template <>
+void basic_set<int>::set_union(const basic_set &other, searchable_bag &out) const {
+	const searchable_bitmap_bag *a = dynamic_cast<const searchable_bitmap_bag *>(bag);
+	const searchable_bitmap_bag *b = dynamic_cast<const searchable_bitmap_bag *>(other.bag);
+	if (a && b) {
+		searchable_bitmap_bag result;
+		searchable_bitmap_bag::union_of(*a, *b, result);
+		store_result(result, out);
+		return;
+	}
+	std::vector<int> left;
+	std::vector<int> right;
+	std::vector<int> result;
+	sorted_ints(*bag, left);
+	sorted_ints(*other.bag, right);
+	result.reserve(left.size() + right.size());
+	std::set_union(left.begin(), left.end(), right.begin(), right.end(),
+		std::back_inserter(result));
+	store_result(result, out);
+}
+
+template <>
+void basic_set<int>::set_intersection(const basic_set &other, searchable_bag &out) const {
+	const searchable_bitmap_bag *a = dynamic_cast<const searchable_bitmap_bag *>(bag);
+	const searchable_bitmap_bag *b = dynamic_cast<const searchable_bitmap_bag *>(other.bag);
+	if (a && b) {
+		searchable_bitmap_bag result;
+		searchable_bitmap_bag::intersection_of(*a, *b, result);
+		store_result(result, out);
+		return;
+	}
+	std::vector<int> left;
+	std::vector<int> right;
+	std::vector<int> result;
+	sorted_ints(*bag, left);
+	sorted_ints(*other.bag, right);
+	sorted_match(left, right, true, result);
+	store_result(result, out);
+}
+
+template <>
+void basic_set<int>::set_difference(const basic_set &other, searchable_bag &out) const {
+	const searchable_bitmap_bag *a = dynamic_cast<const searchable_bitmap_bag *>(bag);
+	const searchable_bitmap_bag *b = dynamic_cast<const searchable_bitmap_bag *>(other.bag);
+	if (a && b) {
+		searchable_bitmap_bag result;
+		searchable_bitmap_bag::difference_of(*a, *b, result);
+		store_result(result, out);
+		return;
+	}
+	std::vector<int> left;
+	std::vector<int> right;
+	std::vector<int> result;
+	sorted_ints(*bag, left);
+	sorted_ints(*other.bag, right);
+	sorted_match(left, right, false, result);
+	store_result(result, out);
+}
+
+template <>
+bool basic_set<int>::is_subset(const basic_set &other) const {
+	const searchable_bitmap_bag *a = dynamic_cast<const searchable_bitmap_bag *>(bag);
+	const searchable_bitmap_bag *b = dynamic_cast<const searchable_bitmap_bag *>(other.bag);
+	if (a && b)
+		return a->is_subset_of(*b);
+	std::vector<int> left;
+	std::vector<int> right;
+	sorted_ints(*bag, left);
+	sorted_ints(*other.bag, right);
+	return std::includes(right.begin(), right.end(), left.begin(), left.end());
+}
@@ -1,31 +1,143 @@
 #pragma once
 #include "searchable_bag.hpp"
+#include "frozen_bag.hpp"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-class set {
+// A view of a bag: copying or moving a set rebinds to the same bag, and
+// swap() exchanges the bags two sets refer to, never their contents.
+template <typename T, typename Compare = std::less<T> >
+class basic_set {
 	private:
-		searchable_bag &bag;
+		basic_searchable_bag<T> *bag;
+		Compare comp;
+
+		// Contents of b, sorted by comp and without repeats.
+		void sorted_contents(const basic_searchable_bag<T> &b, std::vector<T> &out) const {
+			b.collect(out);
+			std::sort(out.begin(), out.end(), comp);
+			std::vector<T> unique;
+			for (size_t i = 0; i < out.size(); i++)
+				if (unique.empty() || comp(unique.back(), out[i]))
+					unique.push_back(out[i]);
+			out.swap(unique);
+		}
+		static void replace_contents(std::vector<T> &values, basic_searchable_bag<T> &out) {
+			out.clear();
+			if (!values.empty())
+				out.insert_unique(values.data(), (int)values.size());
+		}
+
 	public:
-		set(searchable_bag &bg) : bag(bg) {}
-		~set() {}
-		void insert(int item) {
-			if (!bag.has(item))
-				bag.insert(item);
+		basic_set(basic_searchable_bag<T> &bg, const Compare &c = Compare()) : bag(&bg), comp(c) {}
+		basic_set(const basic_set &other) noexcept : bag(other.bag), comp(other.comp) {}
+		basic_set &operator=(const basic_set &other) noexcept {
+			bag = other.bag;
+			comp = other.comp;
+			return *this;
 		}
-		void insert(int *items, int count) {
-			for (int i = 0; i < count; i++)
-				insert(items[i]);
+		~basic_set() {}
+		void swap(basic_set &other) noexcept {
+			std::swap(bag, other.bag);
+			std::swap(comp, other.comp);
 		}
-		bool has(int item) const {
-			return bag.has(item);
+		void insert(T item) {
+			bag->insert_unique(item);
+		}
+		void insert(T *items, int count) {
+			bag->insert_unique(items, count);
+		}
+		bool has(T item) const {
+			return bag->has(item);
+		}
+		bool erase(T item) {
+			return bag->erase(item);
 		}
 		void print() {
-			bag.print();
+			bag->print();
 		}
 		void clear() {
-			bag.clear();
+			bag->clear();
+		}
+		basic_searchable_bag<T> &get_bag() {
+			return *bag;
 		}
-		searchable_bag &get_bag() {
-			return bag;
+		// Snapshot of the current contents for read-only querying. frozen_bag
+		// holds ints, so only sets of int can be frozen.
+		frozen_bag freeze() const {
+			static_assert(std::is_same<T, int>::value, "freeze() is only available on sets of int");
+			return frozen_bag(*bag);
 		}
 
-};
\ No newline at end of file
+		// out is cleared and receives the result; it may be the bag of
+		// either operand. Elements are merged as sorted arrays; for sets of
+		// int, see the specializations below.
+		void set_union(const basic_set &other, basic_searchable_bag<T> &out) const;
+		void set_intersection(const basic_set &other, basic_searchable_bag<T> &out) const;
+		void set_difference(const basic_set &other, basic_searchable_bag<T> &out) const;
+		// True when every element of this set is in other.
+		bool is_subset(const basic_set &other) const;
+
+};
+
+template <typename T, typename Compare>
+void basic_set<T, Compare>::set_union(const basic_set &other, basic_searchable_bag<T> &out) const {
+	std::vector<T> left;
+	std::vector<T> right;
+	std::vector<T> result;
+	sorted_contents(*bag, left);
+	sorted_contents(*other.bag, right);
+	std::set_union(left.begin(), left.end(), right.begin(), right.end(),
+		std::back_inserter(result), comp);
+	replace_contents(result, out);
+}
+
+template <typename T, typename Compare>
+void basic_set<T, Compare>::set_intersection(const basic_set &other, basic_searchable_bag<T> &out) const {
+	std::vector<T> left;
+	std::vector<T> right;
+	std::vector<T> result;
+	sorted_contents(*bag, left);
+	sorted_contents(*other.bag, right);
+	std::set_intersection(left.begin(), left.end(), right.begin(), right.end(),
+		std::back_inserter(result), comp);
+	replace_contents(result, out);
+}
+
+template <typename T, typename Compare>
+void basic_set<T, Compare>::set_difference(const basic_set &other, basic_searchable_bag<T> &out) const {
+	std::vector<T> left;
+	std::vector<T> right;
+	std::vector<T> result;
+	sorted_contents(*bag, left);
+	sorted_contents(*other.bag, right);
+	std::set_difference(left.begin(), left.end(), right.begin(), right.end(),
+		std::back_inserter(result), comp);
+	replace_contents(result, out);
+}
+
+template <typename T, typename Compare>
+bool basic_set<T, Compare>::is_subset(const basic_set &other) const {
+	std::vector<T> left;
+	std::vector<T> right;
+	sorted_contents(*bag, left);
+	sorted_contents(*other.bag, right);
+	return std::includes(right.begin(), right.end(), left.begin(), left.end(), comp);
+}
+
+// Sets of int combine two bitmap bags word by word and any other pair as
+// sorted arrays with SIMD block compares (set.cpp).
+template <>
+void basic_set<int>::set_union(const basic_set &other, searchable_bag &out) const;
+template <>
+void basic_set<int>::set_intersection(const basic_set &other, searchable_bag &out) const;
+template <>
+void basic_set<int>::set_difference(const basic_set &other, searchable_bag &out) const;
+template <>
+bool basic_set<int>::is_subset(const basic_set &other) const;
+
+typedef basic_set<int> set;
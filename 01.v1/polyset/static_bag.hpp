@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// Base of the bags used without virtual dispatch. Derived supplies
+// insert(T), has(T), erase(T), collect() and clear(); this class builds the
+// rest of the searchable_bag operations on top of them. Derived also
+// supplies begin() and end() over a const_iterator, which static_set and
+// virtual_bag pass through. Every call is resolved at compile time through
+// Derived, so a loop over a static bag inlines down to its search, and the
+// bag carries no vptr and no virtual base.
+//
+// Derived may replace any of these with a faster version of its own; it
+// must then bring the remaining overloads back with a using-declaration.
+// virtual_bag adapts a static bag to the searchable_bag interface.
+template <typename Derived, typename T>
+class static_bag {
+
+	protected:
+	Derived &self() {
+		return static_cast<Derived &>(*this);
+	}
+	const Derived &self() const {
+		return static_cast<const Derived &>(*this);
+	}
+
+	public:
+	typedef T value_type;
+
+	void insert(T *items, int count) {
+		for (int i = 0; i < count; i++)
+			self().insert(items[i]);
+	}
+	bool insert_unique(T item) {
+		if (self().has(item))
+			return false;
+		self().insert(item);
+		return true;
+	}
+	int insert_unique(T *items, int count) {
+		int inserted = 0;
+		for (int i = 0; i < count; i++)
+			inserted += self().insert_unique(items[i]);
+		return inserted;
+	}
+	void has_batch(const T *keys, int n, bool *out) const {
+		for (int i = 0; i < n; i++)
+			out[i] = self().has(keys[i]);
+	}
+	void print() const {
+		std::vector<T> values;
+		self().collect(values);
+		for (size_t i = 0; i < values.size(); i++)
+			std::cout << values[i] << " ";
+		std::cout << std::endl;
+	}
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include "static_bag.hpp"
+#include "bag_iterator.hpp"
+#include "bag_prefetch.hpp"
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+// Linear-probing hash set as a static bag. Hash is mixed with a Fibonacci
+// multiply and the top bits pick the home slot, so an identity std::hash
+// still spreads; the table doubles past three quarters full. Duplicates are
+// dropped, like searchable_hash_bag; erase() shifts the rest of the probe
+// chain back instead of leaving a tombstone.
+template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>,
+	typename Alloc = std::allocator<T> >
+class static_hash_bag : public static_bag<static_hash_bag<T, Hash, Equal, Alloc>, T> {
+
+	private:
+	static const int MIN_BITS = 4;
+
+	std::vector<T, Alloc> slots;
+	std::vector<unsigned char> used;
+	int bits;
+	int count;
+	Hash hasher;
+	Equal equal;
+
+	size_t home(const T &item) const {
+		return (size_t)(((uint64_t)hasher(item) * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+	}
+	size_t mask() const {
+		return slots.size() - 1;
+	}
+	// Index of item, or of the free slot that ends its probe chain.
+	size_t find(const T &item, size_t i) const {
+		while (used[i] && !equal(slots[i], item))
+			i = (i + 1) & mask();
+		return i;
+	}
+	void rehash(int new_bits) {
+		std::vector<T, Alloc> old_slots(size_t(1) << new_bits);
+		std::vector<unsigned char> old_used(size_t(1) << new_bits, 0);
+		old_slots.swap(slots);
+		old_used.swap(used);
+		bits = new_bits;
+		for (size_t i = 0; i < old_slots.size(); i++) {
+			if (old_used[i]) {
+				size_t j = find(old_slots[i], home(old_slots[i]));
+				slots[j] = old_slots[i];
+				used[j] = 1;
+			}
+		}
+	}
+
+	struct cursor {
+		const static_hash_bag *bag;
+		size_t i;
+		const T &value() const { return bag->slots[i]; }
+		void next() {
+			i++;
+			skip_free();
+		}
+		void skip_free() {
+			while (i < bag->used.size() && !bag->used[i])
+				i++;
+		}
+		bool operator==(const cursor &other) const { return i == other.i; }
+	};
+
+	public:
+	typedef bag_iterator<cursor, T> const_iterator;
+
+	static_hash_bag() : slots(size_t(1) << MIN_BITS), used(size_t(1) << MIN_BITS, 0),
+		bits(MIN_BITS), count(0) {}
+
+	void insert(T item) {
+		insert_unique(item);
+	}
+	void insert(T *items, int n) {
+		insert_unique(items, n);
+	}
+	bool insert_unique(T item) {
+		size_t i = find(item, home(item));
+		if (used[i])
+			return false;
+		if ((size_t)(count + 1) > slots.size() / 4 * 3) {
+			rehash(bits + 1);
+			i = find(item, home(item));
+		}
+		slots[i] = item;
+		used[i] = 1;
+		count++;
+		return true;
+	}
+	int insert_unique(T *items, int n) {
+		if (n <= 0)
+			return 0;
+		reserve(count + n);
+		int inserted = 0;
+		for (int i = 0; i < n; i++)
+			inserted += insert_unique(items[i]);
+		return inserted;
+	}
+	void reserve(int n) {
+		int b = bits;
+		while ((size_t(1) << b) / 4 * 3 < (size_t)n)
+			b++;
+		if (b > bits)
+			rehash(b);
+	}
+	bool has(T item) const {
+		return used[find(item, home(item))];
+	}
+	// Backward-shift deletion: each later slot of the probe chain moves into
+	// the hole when the hole lies between its home and its slot, so the
+	// chains stay unbroken without tombstones.
+	bool erase(T item) {
+		size_t hole = find(item, home(item));
+		if (!used[hole])
+			return false;
+		for (size_t j = (hole + 1) & mask(); used[j]; j = (j + 1) & mask()) {
+			size_t h = home(slots[j]);
+			if (((j - h) & mask()) >= ((j - hole) & mask())) {
+				slots[hole] = slots[j];
+				hole = j;
+			}
+		}
+		slots[hole] = T();
+		used[hole] = 0;
+		count--;
+		return true;
+	}
+	// Computes up to BATCH_LANES home slots and prefetches them all before
+	// probing any, as searchable_hash_bag does.
+	void has_batch(const T *keys, int n, bool *out) const {
+		const int BATCH_LANES = 16;
+		size_t h[BATCH_LANES];
+		for (int b = 0; b < n; b += BATCH_LANES) {
+			int lanes = std::min(BATCH_LANES, n - b);
+			for (int i = 0; i < lanes; i++) {
+				h[i] = home(keys[b + i]);
+				BAG_PREFETCH(&slots[h[i]]);
+			}
+			for (int i = 0; i < lanes; i++)
+				out[b + i] = used[find(keys[b + i], h[i])];
+		}
+	}
+	void collect(std::vector<T> &out) const {
+		for (size_t i = 0; i < slots.size(); i++)
+			if (used[i])
+				out.push_back(slots[i]);
+	}
+	void clear() {
+		std::vector<T, Alloc>(size_t(1) << MIN_BITS).swap(slots);
+		std::vector<unsigned char>(size_t(1) << MIN_BITS, 0).swap(used);
+		bits = MIN_BITS;
+		count = 0;
+	}
+	int size() const {
+		return count;
+	}
+	// In table order; any insert or erase invalidates the iterators.
+	const_iterator begin() const {
+		cursor c = { this, 0 };
+		c.skip_free();
+		return const_iterator(c);
+	}
+	const_iterator end() const {
+		cursor c = { this, used.size() };
+		return const_iterator(c);
+	}
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "static_bag.hpp"
+#include <utility>
+
+// set over a static bag: the same operations with no virtual call, so each
+// one inlines into the caller's loop. Bag is any static_bag. Like set, a
+// view: copies share the bag and swap() exchanges the bags referred to.
+template <typename Bag>
+class static_set {
+
+	typedef typename Bag::value_type T;
+
+	private:
+		Bag *bag;
+	public:
+		typedef typename Bag::const_iterator const_iterator;
+
+		static_set(Bag &bg) : bag(&bg) {}
+		static_set(const static_set &other) noexcept : bag(other.bag) {}
+		static_set &operator=(const static_set &other) noexcept {
+			bag = other.bag;
+			return *this;
+		}
+		~static_set() {}
+		void swap(static_set &other) noexcept {
+			std::swap(bag, other.bag);
+		}
+		void insert(T item) {
+			bag->insert_unique(item);
+		}
+		void insert(T *items, int count) {
+			bag->insert_unique(items, count);
+		}
+		bool has(T item) const {
+			return bag->has(item);
+		}
+		bool erase(T item) {
+			return bag->erase(item);
+		}
+		void has_batch(const T *keys, int n, bool *out) const {
+			bag->has_batch(keys, n, out);
+		}
+		void print() {
+			bag->print();
+		}
+		void clear() {
+			bag->clear();
+		}
+		const_iterator begin() const {
+			return bag->begin();
+		}
+		const_iterator end() const {
+			return bag->end();
+		}
+		Bag &get_bag() {
+			return *bag;
+		}
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include "static_bag.hpp"
+#include "bag_prefetch.hpp"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// searchable_sorted_array_bag as a static bag: the same branchless,
+// prefetching lower bound and batch merge, ordered by Compare.
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T> >
+class static_sorted_array_bag : public static_bag<static_sorted_array_bag<T, Compare, Alloc>, T> {
+
+	private:
+	std::vector<T, Alloc> data;
+	Compare comp;
+
+	int lower_bound(const T &item) const {
+		int size = (int)data.size();
+		if (size == 0)
+			return 0;
+		const T *first = data.data();
+		const T *base = first;
+		int len = size;
+		while (len > 1) {
+			int half = len / 2;
+			BAG_PREFETCH(base + half / 2);
+			BAG_PREFETCH(base + half + half / 2);
+			base = comp(base[half], item) ? base + half : base;
+			len -= half;
+		}
+		return (int)(base - first) + comp(*base, item);
+	}
+
+	// Appends a sorted batch and merges it into place.
+	void merge(const std::vector<T> &sorted) {
+		size_t middle = data.size();
+		data.insert(data.end(), sorted.begin(), sorted.end());
+		std::inplace_merge(data.begin(), data.begin() + middle, data.end(), comp);
+	}
+
+	public:
+	typedef typename std::vector<T, Alloc>::const_iterator const_iterator;
+
+	static_sorted_array_bag() {}
+	explicit static_sorted_array_bag(const Compare &c) : comp(c) {}
+
+	void insert(T item) {
+		data.insert(data.begin() + lower_bound(item), item);
+	}
+	void insert(T *items, int count) {
+		if (count <= 0)
+			return;
+		std::vector<T> batch(items, items + count);
+		std::sort(batch.begin(), batch.end(), comp);
+		merge(batch);
+	}
+	bool insert_unique(T item) {
+		int pos = lower_bound(item);
+		if (pos < (int)data.size() && !comp(item, data[pos]))
+			return false;
+		data.insert(data.begin() + pos, item);
+		return true;
+	}
+	// Sorts and deduplicates the batch, drops what is already stored in one
+	// pass alongside the data, and merges the rest.
+	int insert_unique(T *items, int count) {
+		if (count <= 0)
+			return 0;
+		std::vector<T> batch(items, items + count);
+		std::sort(batch.begin(), batch.end(), comp);
+		Compare c = comp;
+		batch.erase(std::unique(batch.begin(), batch.end(),
+			[c](const T &a, const T &b) { return !c(a, b); }), batch.end());
+		std::vector<T> fresh;
+		fresh.reserve(batch.size());
+		std::set_difference(batch.begin(), batch.end(), data.begin(), data.end(),
+			std::back_inserter(fresh), comp);
+		merge(fresh);
+		return (int)fresh.size();
+	}
+	bool has(T item) const {
+		int i = lower_bound(item);
+		return i < (int)data.size() && !comp(item, data[i]);
+	}
+	bool erase(T item) {
+		int i = lower_bound(item);
+		if (i == (int)data.size() || comp(item, data[i]))
+			return false;
+		data.erase(data.begin() + i);
+		return true;
+	}
+	void collect(std::vector<T> &out) const {
+		out.insert(out.end(), data.begin(), data.end());
+	}
+	void clear() {
+		std::vector<T, Alloc>().swap(data);
+	}
+	const_iterator begin() const {
+		return data.begin();
+	}
+	const_iterator end() const {
+		return data.end();
+	}
+	int size() const {
+		return (int)data.size();
+	}
+};
@@ -1,32 +1,370 @@
 #pragma once
 
 #include "bag.hpp"
+#include "bag_iterator.hpp"
+#include "bag_trace.hpp"
+#include "node_pool.hpp"
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+// Unbalanced binary search tree of T ordered by Compare; two elements are
+// the same when neither is less than the other. Nodes come from a
+// node_pool on Alloc, which frees them without running destructors.
+// Nodes keep a parent link, so iteration, copying and destruction are loops
+// that need no stack: a tree built from sorted input is a list as deep as
+// the bag is large.
+//
+// Node creation, duplicates and frees are reported to Trace (bag_trace.hpp)
+// instead of std::cout; the default null_trace compiles away, and
+// ring_trace<T> records them in memory for tracer() to read.
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T>,
+  typename Trace = null_trace>
+class basic_tree_bag : virtual public basic_bag<T> {
+  static_assert(std::is_trivially_destructible<T>::value,
+    "tree bag nodes are released without running destructors");
 
-class tree_bag : virtual public bag {
 protected:
   struct node {
     node *l;
     node *r;
-    int value;
+    node *p;
+    T value;
   };
   node *tree;
+  node_pool<node, Alloc> pool;
+  Compare comp;
+  Trace trace;
+
+  static node *leftmost(node *);
+  static node *successor(node *);
+
+  struct cursor {
+    node *current;
+    const T &value() const { return current->value; }
+    void next() { current = successor(current); }
+    bool operator==(const cursor &other) const { return current == other.current; }
+  };
+
+  // Adds item unless it is present, in one walk; true when it was added.
+  bool try_insert(T item);
+  // Unlinks the node holding item and returns it to the pool; a node with
+  // two children takes its successor's value and the successor goes.
+  bool try_erase(T item);
 
 public:
-  tree_bag();
-  tree_bag(const tree_bag &);
-  virtual ~tree_bag();
-  tree_bag &operator=(const tree_bag &);
+  typedef bag_iterator<cursor, T> const_iterator;
 
+  basic_tree_bag();
+  basic_tree_bag(const basic_tree_bag &);
+  basic_tree_bag(basic_tree_bag &&) noexcept;
+  virtual ~basic_tree_bag();
+  basic_tree_bag &operator=(const basic_tree_bag &);
+  basic_tree_bag &operator=(basic_tree_bag &&) noexcept;
+
+  // Exchanges the roots and the node pools; no node is copied.
+  void swap(basic_tree_bag &other) noexcept;
+
+  // Nodes belong to this bag's pool: an extracted tree stays valid until
+  // the bag is cleared or destroyed, and set_tree() copies its argument.
   node *extract_tree();
   void set_tree(node *);
 
-  virtual void insert(int);
-  virtual void insert(int *array, int size);
+  virtual void insert(T);
+  virtual void insert(T *array, int size);
   virtual void print() const;
+  virtual void collect(std::vector<T> &) const;
   virtual void clear();
 
+  // In order, smallest first.
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  const Trace &tracer() const;
+
 private:
-  static void destroy_tree(node *);
-  static void print_node(node *);
-  static node *copy_node(node *);
-};
\ No newline at end of file
+  void destroy_tree(node *);
+  void print_node(node *) const;
+  static int count_nodes(node *);
+  node *copy_node(node *);
+};
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+basic_tree_bag<T, Compare, Alloc, Trace>::basic_tree_bag() {
+	tree = nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+basic_tree_bag<T, Compare, Alloc, Trace>::basic_tree_bag(const basic_tree_bag &src) : comp(src.comp) {
+	pool.reserve(count_nodes(src.tree));
+	tree = copy_node(src.tree);
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+basic_tree_bag<T, Compare, Alloc, Trace>::basic_tree_bag(basic_tree_bag &&src) noexcept : comp(src.comp) {
+	tree = nullptr;
+	std::swap(tree, src.tree);
+	pool.swap(src.pool);
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+basic_tree_bag<T, Compare, Alloc, Trace>::~basic_tree_bag() {
+	tree = nullptr;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+basic_tree_bag<T, Compare, Alloc, Trace> &basic_tree_bag<T, Compare, Alloc, Trace>::operator=(const basic_tree_bag &src) {
+	if (this != &src) {
+		pool.release();
+		comp = src.comp;
+		pool.reserve(count_nodes(src.tree));
+		tree = copy_node(src.tree);
+	}
+	return *this;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+basic_tree_bag<T, Compare, Alloc, Trace> &basic_tree_bag<T, Compare, Alloc, Trace>::operator=(basic_tree_bag &&src) noexcept {
+	if (this != &src) {
+		basic_tree_bag::clear();
+		swap(src);
+	}
+	return *this;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::swap(basic_tree_bag &other) noexcept {
+	std::swap(tree, other.tree);
+	pool.swap(other.pool);
+	std::swap(comp, other.comp);
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+typename basic_tree_bag<T, Compare, Alloc, Trace>::node *basic_tree_bag<T, Compare, Alloc, Trace>::extract_tree() {
+	node *temp = tree;
+	tree = nullptr;
+	return temp;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::set_tree(node *new_tree) {
+	node *copy = copy_node(new_tree);
+	destroy_tree(tree);
+	tree = copy;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::insert(T item) {
+	try_insert(item);
+}
+
+// Walks the link that would hold item, so a duplicate is found before any
+// node is allocated. depth only feeds the trace.
+template <typename T, typename Compare, typename Alloc, typename Trace>
+bool basic_tree_bag<T, Compare, Alloc, Trace>::try_insert(T item) {
+	node *parent = nullptr;
+	node **link = &tree;
+	int depth = 0;
+	while (*link != nullptr) {
+		parent = *link;
+		if (comp(item, parent->value)) {
+			link = &parent->l;
+		} else if (comp(parent->value, item)) {
+			link = &parent->r;
+		} else {
+			trace.on_duplicate(item, depth);
+			return false;
+		}
+		depth++;
+	}
+	node *new_node = pool.allocate();
+	trace.on_allocate(item, depth);
+	new_node->value = item;
+	new_node->l = nullptr;
+	new_node->r = nullptr;
+	new_node->p = parent;
+	*link = new_node;
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+bool basic_tree_bag<T, Compare, Alloc, Trace>::try_erase(T item) {
+	node **link = &tree;
+	while (*link != nullptr) {
+		if (comp(item, (*link)->value))
+			link = &(*link)->l;
+		else if (comp((*link)->value, item))
+			link = &(*link)->r;
+		else
+			break;
+	}
+	node *target = *link;
+	if (target == nullptr)
+		return false;
+	trace.on_free(target->value);
+	if (target->l && target->r) {
+		node **succ = &target->r;
+		while ((*succ)->l)
+			succ = &(*succ)->l;
+		node *s = *succ;
+		*succ = s->r;
+		if (s->r)
+			s->r->p = s->p;
+		target->value = s->value;
+		target = s;
+	} else {
+		node *child = target->l ? target->l : target->r;
+		*link = child;
+		if (child)
+			child->p = target->p;
+	}
+	pool.deallocate(target);
+	return true;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::insert(T *items, int count) {
+	for (int i = 0; i < count; i++) {
+		insert(items[i]);
+	}
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::print() const {
+	print_node(tree);
+	std::cout << std::endl;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::collect(std::vector<T> &out) const {
+	for (node *current = leftmost(tree); current; current = successor(current))
+		out.push_back(current->value);
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::clear() {
+	pool.release();
+	tree = nullptr;
+	trace.on_clear();
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+typename basic_tree_bag<T, Compare, Alloc, Trace>::const_iterator basic_tree_bag<T, Compare, Alloc, Trace>::begin() const {
+	cursor c = { leftmost(tree) };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+typename basic_tree_bag<T, Compare, Alloc, Trace>::const_iterator basic_tree_bag<T, Compare, Alloc, Trace>::end() const {
+	cursor c = { nullptr };
+	return const_iterator(c);
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+const Trace &basic_tree_bag<T, Compare, Alloc, Trace>::tracer() const {
+	return trace;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+typename basic_tree_bag<T, Compare, Alloc, Trace>::node *basic_tree_bag<T, Compare, Alloc, Trace>::leftmost(node *current) {
+	if (current == nullptr)
+		return nullptr;
+	while (current->l)
+		current = current->l;
+	return current;
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+typename basic_tree_bag<T, Compare, Alloc, Trace>::node *basic_tree_bag<T, Compare, Alloc, Trace>::successor(node *current) {
+	if (current->r)
+		return leftmost(current->r);
+	while (current->p && current->p->r == current)
+		current = current->p;
+	return current->p;
+}
+
+// Reports the values to the trace in pre-order and frees each node once
+// both its subtrees are gone. prev is the node the walk came
+// from; it is only compared, never read, after it has been freed.
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::destroy_tree(node *root) {
+	node *prev = nullptr;
+	node *current = root;
+	while (current) {
+		node *next;
+		if (current == root ? prev == nullptr : prev == current->p) {
+			trace.on_free(current->value);
+			next = current->l ? current->l : current->r;
+		} else {
+			next = prev == current->l ? current->r : nullptr;
+		}
+		if (next == nullptr) {
+			next = current == root ? nullptr : current->p;
+			pool.deallocate(current);
+		}
+		prev = current;
+		current = next;
+	}
+}
+
+// Skips elements equivalent to T(), the 0 of the int bag.
+template <typename T, typename Compare, typename Alloc, typename Trace>
+void basic_tree_bag<T, Compare, Alloc, Trace>::print_node(node *current) const {
+	for (current = leftmost(current); current; current = successor(current))
+		if (comp(current->value, T()) || comp(T(), current->value))
+			std::cout << current->value << " ";
+}
+
+template <typename T, typename Compare, typename Alloc, typename Trace>
+int basic_tree_bag<T, Compare, Alloc, Trace>::count_nodes(node *current) {
+	int count = 0;
+	for (current = leftmost(current); current; current = successor(current))
+		count++;
+	return count;
+}
+
+// Pre-order copy that walks source and destination in lockstep, using the
+// parent links of both to climb back up; src may be any subtree.
+template <typename T, typename Compare, typename Alloc, typename Trace>
+typename basic_tree_bag<T, Compare, Alloc, Trace>::node *basic_tree_bag<T, Compare, Alloc, Trace>::copy_node(node *src) {
+	if (src == nullptr)
+		return nullptr;
+	node *root = pool.allocate();
+	root->value = src->value;
+	root->l = nullptr;
+	root->r = nullptr;
+	root->p = nullptr;
+
+	node *s = src;
+	node *d = root;
+	while (true) {
+		node *next = nullptr;
+		if (s->l && d->l == nullptr)
+			next = s->l;
+		else if (s->r && d->r == nullptr)
+			next = s->r;
+		if (next) {
+			node *copy = pool.allocate();
+			copy->value = next->value;
+			copy->l = nullptr;
+			copy->r = nullptr;
+			copy->p = d;
+			if (next == s->l)
+				d->l = copy;
+			else
+				d->r = copy;
+			s = next;
+			d = copy;
+		} else {
+			if (s == src)
+				break;
+			s = s->p;
+			d = d->p;
+		}
+	}
+	return root;
+}
+
+extern template class basic_tree_bag<int>;
+typedef basic_tree_bag<int> tree_bag;
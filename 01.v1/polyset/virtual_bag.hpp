@@ -0,0 +1,64 @@
+#pragma once
+#include "searchable_bag.hpp"
+
+// Puts a static bag behind the searchable_bag interface, for code that
+// takes any bag (set, the set algebra, the benchmarks). Each call costs
+// one virtual dispatch and then runs the static bag's own code.
+template <typename Bag>
+class virtual_bag : public basic_searchable_bag<typename Bag::value_type> {
+
+	typedef typename Bag::value_type T;
+
+	private:
+	Bag bag;
+
+	public:
+	typedef typename Bag::const_iterator const_iterator;
+
+	virtual_bag() {}
+	explicit virtual_bag(const Bag &b) : bag(b) {}
+
+	void insert(T item) {
+		bag.insert(item);
+	}
+	void insert(T *items, int count) {
+		bag.insert(items, count);
+	}
+	bool insert_unique(T item) {
+		return bag.insert_unique(item);
+	}
+	int insert_unique(T *items, int count) {
+		return bag.insert_unique(items, count);
+	}
+	bool has(T item) const {
+		return bag.has(item);
+	}
+	bool erase(T item) {
+		return bag.erase(item);
+	}
+	void has_batch(const T *keys, int n, bool *out) const {
+		bag.has_batch(keys, n, out);
+	}
+	void print() const {
+		bag.print();
+	}
+	void collect(std::vector<T> &out) const {
+		bag.collect(out);
+	}
+	void clear() {
+		bag.clear();
+	}
+	const_iterator begin() const {
+		return bag.begin();
+	}
+	const_iterator end() const {
+		return bag.end();
+	}
+
+	Bag &get() {
+		return bag;
+	}
+	const Bag &get() const {
+		return bag;
+	}
+};
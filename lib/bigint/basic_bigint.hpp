@@ -0,0 +1,742 @@
+#ifndef BASIC_BIGINT_HPP
+#define BASIC_BIGINT_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cctype>
+#include <cstdint>
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+// Header-only signed arbitrary precision integer shared by the 01.v1 and
+// 02.v1 bigint exercises.
+//
+// The magnitude is kept as decimal digit characters, least significant
+// first, in a container chosen by StoragePolicy and allocated through
+// AllocPolicy. Zero is never negative.
+
+// Storage policies: a metafunction from an allocator of char to the digit
+// container. Both containers expose the same sequence interface.
+struct string_storage {
+    template <typename Alloc>
+    struct rebind {
+        typedef std::basic_string<char, std::char_traits<char>, Alloc> type;
+    };
+};
+
+struct vector_storage {
+    template <typename Alloc>
+    struct rebind {
+        typedef std::vector<char, Alloc> type;
+    };
+};
+
+// Backend used by the exercise `bigint` typedefs. string_storage wins the
+// benchmark (SSO keeps small values off the heap); define BIGINT_STORAGE
+// before including to compare backends.
+#ifndef BIGINT_STORAGE
+# define BIGINT_STORAGE string_storage
+#endif
+
+// Native integer types accepted by the mixed bigint/native overloads.
+// std::is_integral does not cover __int128 in strict ISO mode. bool and the
+// character types are integral too but are turned away: `b + 'x'` would
+// otherwise add 120. signed and unsigned char stay, as small integers.
+template <typename T> struct bigint_is_native : std::is_integral<T> {};
+#ifdef __SIZEOF_INT128__
+template <> struct bigint_is_native<__int128> : std::true_type {};
+template <> struct bigint_is_native<unsigned __int128> : std::true_type {};
+#endif
+template <> struct bigint_is_native<bool> : std::false_type {};
+template <> struct bigint_is_native<char> : std::false_type {};
+template <> struct bigint_is_native<wchar_t> : std::false_type {};
+template <> struct bigint_is_native<char16_t> : std::false_type {};
+template <> struct bigint_is_native<char32_t> : std::false_type {};
+#ifdef __cpp_char8_t
+template <> struct bigint_is_native<char8_t> : std::false_type {};
+#endif
+
+template <typename StoragePolicy = string_storage, typename AllocPolicy = std::allocator<char> >
+class basic_bigint {
+public:
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 native_max;
+#else
+    typedef unsigned long long native_max;
+#endif
+    typedef typename std::allocator_traits<AllocPolicy>::template rebind_alloc<char> allocator_type;
+    typedef typename StoragePolicy::template rebind<allocator_type>::type storage_type;
+
+private:
+    storage_type digits;
+    bool negative;
+
+    template <typename T>
+    struct if_native : std::enable_if<bigint_is_native<T>::value> {};
+
+    template <typename T>
+    static bool isNegative(T num, std::true_type) { return num < T(0); }
+    template <typename T>
+    static bool isNegative(T, std::false_type) { return false; }
+    template <typename T>
+    static bool isNegative(T num) {
+        return isNegative(num, std::integral_constant<bool, (T(-1) < T(0))>());
+    }
+
+    // Absolute value of a native integer; well defined for the minimum of
+    // every signed type.
+    template <typename T>
+    static native_max magnitude(T num) {
+        return isNegative(num) ? native_max(0) - static_cast<native_max>(num)
+                               : static_cast<native_max>(num);
+    }
+
+    void setZero() {
+        digits.assign(1, '0');
+        negative = false;
+    }
+
+    void removeLeadingZeros() {
+        while (digits.size() > 1 && digits.back() == '0')
+            digits.pop_back();
+    }
+
+    bool isZero() const {
+        return digits.size() == 1 && digits[0] == '0';
+    }
+
+    void parse(const char* first, const char* last) {
+        negative = false;
+        bool neg = first != last && *first == '-';
+        if (neg)
+            ++first;
+        if (first == last) {
+            setZero();
+            return;
+        }
+        for (const char* p = first; p != last; ++p) {
+            if (!std::isdigit(static_cast<unsigned char>(*p))) {
+                setZero();
+                return;
+            }
+        }
+        digits.assign(std::reverse_iterator<const char*>(last),
+                      std::reverse_iterator<const char*>(first));
+        removeLeadingZeros();
+        negative = neg && !isZero();
+    }
+
+    static int compareDigits(const storage_type& a, const storage_type& b) {
+        if (a.size() != b.size())
+            return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0; ) {
+            if (a[i] != b[i])
+                return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // digits += mag. mag may alias digits: every position is read before it
+    // is written.
+    void addDigits(const storage_type& mag) {
+        size_t len = mag.size();
+        if (digits.size() < len)
+            digits.resize(len, '0');
+        int carry = 0;
+        size_t i = 0;
+        for (; i < len; ++i) {
+            int sum = digits[i] - '0' + mag[i] - '0' + carry;
+            carry = sum >= 10;
+            digits[i] = static_cast<char>('0' + (carry ? sum - 10 : sum));
+        }
+        for (; carry && i < digits.size(); ++i) {
+            carry = digits[i] == '9';
+            digits[i] = carry ? '0' : static_cast<char>(digits[i] + 1);
+        }
+        if (carry)
+            digits.push_back('1');
+    }
+
+    // digits -= mag, requires |digits| >= |mag|.
+    void subDigits(const storage_type& mag) {
+        int borrow = 0;
+        size_t i = 0;
+        for (; i < mag.size(); ++i) {
+            int diff = digits[i] - mag[i] - borrow;
+            borrow = diff < 0;
+            digits[i] = static_cast<char>('0' + (borrow ? diff + 10 : diff));
+        }
+        for (; borrow && i < digits.size(); ++i) {
+            borrow = digits[i] == '0';
+            digits[i] = borrow ? '9' : static_cast<char>(digits[i] - 1);
+        }
+        removeLeadingZeros();
+    }
+
+    // digits = mag - digits, requires |mag| > |digits|.
+    void subFromDigits(const storage_type& mag) {
+        size_t old = digits.size();
+        digits.resize(mag.size(), '0');
+        int borrow = 0;
+        for (size_t i = 0; i < mag.size(); ++i) {
+            if (i >= old && !borrow) {
+                std::copy(mag.begin() + i, mag.end(), digits.begin() + i);
+                break;
+            }
+            int diff = mag[i] - digits[i] - borrow;
+            borrow = diff < 0;
+            digits[i] = static_cast<char>('0' + (borrow ? diff + 10 : diff));
+        }
+        removeLeadingZeros();
+    }
+
+    // *this += (neg ? -mag : mag). Opposite signs turn into an in-place
+    // magnitude subtraction.
+    void addSigned(const storage_type& mag, bool neg) {
+        if (negative == neg) {
+            addDigits(mag);
+            return;
+        }
+        if (compareDigits(digits, mag) >= 0) {
+            subDigits(mag);
+        } else {
+            subFromDigits(mag);
+            negative = neg;
+        }
+        if (isZero())
+            negative = false;
+    }
+
+    // Digit loops are instantiated for uint64_t as well so that values which
+    // fit in 64 bits avoid the much slower 128-bit division.
+    template <typename U>
+    static size_t nativeToDigits(U num, char* buf) {
+        size_t len = 0;
+        do {
+            buf[len++] = static_cast<char>('0' + num % 10);
+            num /= 10;
+        } while (num);
+        return len;
+    }
+
+    static size_t toDigits(native_max num, char* buf) {
+        return num <= UINT64_MAX ? nativeToDigits(static_cast<uint64_t>(num), buf)
+                                 : nativeToDigits(num, buf);
+    }
+
+    template <typename U>
+    void addNativeDigits(U num) {
+        int carry = 0;
+        for (size_t i = 0; num || carry; ++i) {
+            if (i == digits.size())
+                digits.push_back('0');
+            int sum = digits[i] - '0' + static_cast<int>(num % 10) + carry;
+            carry = sum >= 10;
+            digits[i] = static_cast<char>('0' + (carry ? sum - 10 : sum));
+            num /= 10;
+        }
+    }
+
+    // digits -= num, requires digits >= num.
+    template <typename U>
+    void subNativeDigits(U num) {
+        int borrow = 0;
+        for (size_t i = 0; num || borrow; ++i) {
+            int diff = digits[i] - '0' - static_cast<int>(num % 10) - borrow;
+            borrow = diff < 0;
+            digits[i] = static_cast<char>('0' + (borrow ? diff + 10 : diff));
+            num /= 10;
+        }
+    }
+
+    void assignMagnitude(native_max num) {
+        // At most 39 decimal digits fit in 128 bits.
+        char buf[40];
+        digits.assign(buf, buf + toDigits(num, buf));
+        if (num == 0)
+            negative = false;
+    }
+
+    void addSigned(native_max num, bool neg) {
+        if (num == 0)
+            return;
+        if (negative == neg) {
+            if (num <= UINT64_MAX)
+                addNativeDigits(static_cast<uint64_t>(num));
+            else
+                addNativeDigits(num);
+            return;
+        }
+        if (compareMagnitude(num) >= 0) {
+            if (num <= UINT64_MAX)
+                subNativeDigits(static_cast<uint64_t>(num));
+            else
+                subNativeDigits(num);
+            removeLeadingZeros();
+        } else {
+            // |*this| < num, so the difference fits in a native integer.
+            assignMagnitude(num - toMagnitude(num));
+            negative = neg;
+        }
+        if (isZero())
+            negative = false;
+    }
+
+    int compareMagnitude(native_max num) const {
+        char buf[40];
+        if (digits.size() > sizeof(buf))
+            return 1;
+        size_t len = toDigits(num, buf);
+        if (digits.size() != len)
+            return digits.size() < len ? -1 : 1;
+        for (size_t i = len; i-- > 0; ) {
+            if (digits[i] != buf[i])
+                return digits[i] < buf[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    native_max toMagnitude(native_max limit) const {
+        native_max value = 0;
+        for (size_t i = digits.size(); i-- > 0; ) {
+            unsigned int d = digits[i] - '0';
+            if (value > (limit - d) / 10)
+                return limit;
+            value = value * 10 + d;
+        }
+        return value;
+    }
+
+    void shiftLeft(size_t shift) {
+        if (isZero() || shift == 0)
+            return;
+        digits.insert(digits.begin(), shift, '0');
+    }
+
+    void shiftRight(size_t shift) {
+        if (shift == 0)
+            return;
+        if (shift >= digits.size())
+            setZero();
+        else
+            digits.erase(digits.begin(), digits.begin() + shift);
+    }
+
+    // Shift amounts, given as a bigint or as a native integer, saturate to
+    // size_t; the memory needed for a larger left shift could not be
+    // allocated anyway.
+    size_t shiftAmount() const {
+        return shiftAmount(toMagnitude(std::numeric_limits<size_t>::max()));
+    }
+
+    static size_t shiftAmount(native_max shift) {
+        native_max limit = std::numeric_limits<size_t>::max();
+        return static_cast<size_t>(shift > limit ? limit : shift);
+    }
+
+public:
+    basic_bigint() : digits(1, '0'), negative(false) {}
+    basic_bigint(const std::string& str) { parse(str.data(), str.data() + str.size()); }
+    basic_bigint(const char* str) {
+        const char* end = str;
+        while (*end)
+            ++end;
+        parse(str, end);
+    }
+    template <typename T>
+    basic_bigint(T num, typename if_native<T>::type* = 0) : negative(isNegative(num)) {
+        assignMagnitude(magnitude(num));
+    }
+
+    basic_bigint(const basic_bigint&) = default;
+    basic_bigint(basic_bigint&&) = default;
+    basic_bigint& operator=(const basic_bigint&) = default;
+    basic_bigint& operator=(basic_bigint&&) = default;
+    ~basic_bigint() = default;
+
+    void swap(basic_bigint& other) {
+        using std::swap;
+        swap(digits, other.digits);
+        swap(negative, other.negative);
+    }
+
+    // Arithmetic. The rvalue overloads reuse the left operand's buffer.
+    basic_bigint& operator+=(const basic_bigint& other) {
+        addSigned(other.digits, other.negative);
+        return *this;
+    }
+    basic_bigint& operator-=(const basic_bigint& other) {
+        // Read the sign first: other may be *this.
+        bool neg = !other.negative;
+        addSigned(other.digits, neg);
+        return *this;
+    }
+    basic_bigint operator+(const basic_bigint& other) const & {
+        basic_bigint result(*this);
+        return result += other;
+    }
+    basic_bigint operator+(const basic_bigint& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+    basic_bigint operator-(const basic_bigint& other) const & {
+        basic_bigint result(*this);
+        return result -= other;
+    }
+    basic_bigint operator-(const basic_bigint& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+    basic_bigint operator-() const & {
+        basic_bigint result(*this);
+        result.negative = !negative && !isZero();
+        return result;
+    }
+    basic_bigint operator-() && {
+        negative = !negative && !isZero();
+        return std::move(*this);
+    }
+
+    basic_bigint& operator++() {
+        addSigned(1, false);
+        return *this;
+    }
+    basic_bigint operator++(int) {
+        basic_bigint temp(*this);
+        addSigned(1, false);
+        return temp;
+    }
+    basic_bigint& operator--() {
+        addSigned(1, true);
+        return *this;
+    }
+    basic_bigint operator--(int) {
+        basic_bigint temp(*this);
+        addSigned(1, true);
+        return temp;
+    }
+
+    // -1, 0 or 1.
+    int sign() const {
+        if (negative)
+            return -1;
+        return isZero() ? 0 : 1;
+    }
+
+    // Comparison reads signs and digits in place and never allocates.
+    int compare(const basic_bigint& other) const {
+        if (negative != other.negative)
+            return negative ? -1 : 1;
+        int c = compareDigits(digits, other.digits);
+        return negative ? -c : c;
+    }
+    bool operator==(const basic_bigint& other) const {
+        return negative == other.negative && digits == other.digits;
+    }
+    bool operator!=(const basic_bigint& other) const { return !(*this == other); }
+    bool operator<(const basic_bigint& other) const { return compare(other) < 0; }
+    bool operator>(const basic_bigint& other) const { return compare(other) > 0; }
+    bool operator<=(const basic_bigint& other) const { return compare(other) <= 0; }
+    bool operator>=(const basic_bigint& other) const { return compare(other) >= 0; }
+
+    // Digit shifts. A negative amount shifts the other way; the sign is
+    // kept unless the result becomes zero.
+    basic_bigint& operator<<=(const basic_bigint& shift) {
+        if (shift.negative)
+            shiftRight(shift.shiftAmount());
+        else
+            shiftLeft(shift.shiftAmount());
+        return *this;
+    }
+    basic_bigint& operator>>=(const basic_bigint& shift) {
+        if (shift.negative)
+            shiftLeft(shift.shiftAmount());
+        else
+            shiftRight(shift.shiftAmount());
+        return *this;
+    }
+    basic_bigint operator<<(const basic_bigint& shift) const & {
+        basic_bigint result(*this);
+        return result <<= shift;
+    }
+    basic_bigint operator<<(const basic_bigint& shift) && {
+        *this <<= shift;
+        return std::move(*this);
+    }
+    basic_bigint operator>>(const basic_bigint& shift) const & {
+        basic_bigint result(*this);
+        return result >>= shift;
+    }
+    basic_bigint operator>>(const basic_bigint& shift) && {
+        *this >>= shift;
+        return std::move(*this);
+    }
+
+    // Mixed bigint/native arithmetic, comparison and shifts. They operate on
+    // the digits directly and never build a temporary bigint; like the
+    // bigint overloads, rvalue left operands are updated in place.
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint&>::type
+    operator+=(T num) {
+        addSigned(magnitude(num), isNegative(num));
+        return *this;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint&>::type
+    operator-=(T num) {
+        addSigned(magnitude(num), !isNegative(num));
+        return *this;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator+(T num) const & {
+        basic_bigint result(*this);
+        return result += num;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator+(T num) && {
+        *this += num;
+        return std::move(*this);
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator-(T num) const & {
+        basic_bigint result(*this);
+        return result -= num;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator-(T num) && {
+        *this -= num;
+        return std::move(*this);
+    }
+
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, int>::type
+    compare(T num) const {
+        if (negative != isNegative(num))
+            return negative ? -1 : 1;
+        int c = compareMagnitude(magnitude(num));
+        return negative ? -c : c;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, bool>::type
+    operator==(T num) const { return compare(num) == 0; }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, bool>::type
+    operator!=(T num) const { return compare(num) != 0; }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, bool>::type
+    operator<(T num) const { return compare(num) < 0; }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, bool>::type
+    operator>(T num) const { return compare(num) > 0; }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, bool>::type
+    operator<=(T num) const { return compare(num) <= 0; }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, bool>::type
+    operator>=(T num) const { return compare(num) >= 0; }
+
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint&>::type
+    operator<<=(T shift) {
+        if (isNegative(shift))
+            shiftRight(shiftAmount(magnitude(shift)));
+        else
+            shiftLeft(shiftAmount(magnitude(shift)));
+        return *this;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint&>::type
+    operator>>=(T shift) {
+        if (isNegative(shift))
+            shiftLeft(shiftAmount(magnitude(shift)));
+        else
+            shiftRight(shiftAmount(magnitude(shift)));
+        return *this;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator<<(T shift) const & {
+        basic_bigint result(*this);
+        return result <<= shift;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator<<(T shift) && {
+        *this <<= shift;
+        return std::move(*this);
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator>>(T shift) const & {
+        basic_bigint result(*this);
+        return result >>= shift;
+    }
+    template <typename T>
+    typename std::enable_if<bigint_is_native<T>::value, basic_bigint>::type
+    operator>>(T shift) && {
+        *this >>= shift;
+        return std::move(*this);
+    }
+
+    // Conversions back to native integers saturate at the target's range.
+    bool fits_u64() const {
+        return !negative && compareMagnitude(std::numeric_limits<uint64_t>::max()) <= 0;
+    }
+    uint64_t to_u64() const {
+        if (negative)
+            return 0;
+        return static_cast<uint64_t>(toMagnitude(std::numeric_limits<uint64_t>::max()));
+    }
+    int64_t to_i64() const {
+        native_max limit = std::numeric_limits<int64_t>::max();
+        if (negative)
+            return -1 - static_cast<int64_t>(toMagnitude(limit + 1) - 1);
+        return static_cast<int64_t>(toMagnitude(limit));
+    }
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 to_u128() const {
+        if (negative)
+            return 0;
+        return toMagnitude(~static_cast<unsigned __int128>(0));
+    }
+    __int128 to_i128() const {
+        native_max limit = ~static_cast<unsigned __int128>(0) >> 1;
+        if (negative)
+            return -1 - static_cast<__int128>(toMagnitude(limit + 1) - 1);
+        return static_cast<__int128>(toMagnitude(limit));
+    }
+#endif
+
+    // Decimal digit statistics of the magnitude, computed without copying
+    // the digits. Zero has one digit and no trailing zeros.
+    size_t digit_count() const {
+        return digits.size();
+    }
+
+    uint64_t digit_sum() const {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(digits.data());
+        size_t n = digits.size();
+        size_t i = 0;
+        uint64_t sum = 0;
+#ifdef __SSE2__
+        // psadbw adds 16 bytes into two 64-bit lanes; the '0' bias of every
+        // byte is removed once at the end.
+        __m128i acc = _mm_setzero_si128();
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(chunk, zero));
+        }
+        uint64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        sum = lanes[0] + lanes[1];
+#endif
+        for (; i < n; ++i)
+            sum += p[i];
+        return sum - static_cast<uint64_t>('0') * n;
+    }
+
+    size_t trailing_zeros() const {
+        if (isZero())
+            return 0;
+        // Digits are stored least significant first, so trailing zeros of
+        // the number are leading '0' bytes of the storage.
+        const char* p = digits.data();
+        size_t n = digits.size();
+        size_t i = 0;
+#ifdef __SSE2__
+        const __m128i zeros = _mm_set1_epi8('0');
+        for (; i + 16 <= n; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zeros)));
+            if (mask != 0xFFFF)
+                return i + static_cast<size_t>(__builtin_ctz(~mask));
+        }
+#endif
+        while (i < n && p[i] == '0')
+            ++i;
+        return i;
+    }
+
+    // The k most significant digits, most significant first.
+    std::string leading_digits(size_t k) const {
+        if (k > digits.size())
+            k = digits.size();
+        return std::string(digits.rbegin(), digits.rbegin() + k);
+    }
+
+    // Reversed decimal digits of the magnitude; the sign is not included.
+    std::string getDigits() const {
+        return std::string(digits.begin(), digits.end());
+    }
+
+    // Writes the number in base 10 without a trailing newline or flush.
+    void print(std::ostream& os) const {
+        char buf[256];
+        size_t len = 0;
+        if (negative)
+            buf[len++] = '-';
+        for (size_t i = digits.size(); i-- > 0; ) {
+            buf[len++] = digits[i];
+            if (len == sizeof(buf)) {
+                os.write(buf, static_cast<std::streamsize>(len));
+                len = 0;
+            }
+        }
+        os.write(buf, static_cast<std::streamsize>(len));
+    }
+};
+
+template <typename S, typename A>
+void swap(basic_bigint<S, A>& a, basic_bigint<S, A>& b) {
+    a.swap(b);
+}
+
+template <typename S, typename A>
+basic_bigint<S, A> abs(const basic_bigint<S, A>& num) {
+    return num.sign() < 0 ? -num : num;
+}
+
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, basic_bigint<S, A> >::type
+operator+(T num, const basic_bigint<S, A>& b) { return b + num; }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, basic_bigint<S, A> >::type
+operator-(T num, const basic_bigint<S, A>& b) { return -(b - num); }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, bool>::type
+operator==(T num, const basic_bigint<S, A>& b) { return b.compare(num) == 0; }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, bool>::type
+operator!=(T num, const basic_bigint<S, A>& b) { return b.compare(num) != 0; }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, bool>::type
+operator<(T num, const basic_bigint<S, A>& b) { return b.compare(num) > 0; }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, bool>::type
+operator>(T num, const basic_bigint<S, A>& b) { return b.compare(num) < 0; }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, bool>::type
+operator<=(T num, const basic_bigint<S, A>& b) { return b.compare(num) >= 0; }
+template <typename T, typename S, typename A>
+typename std::enable_if<bigint_is_native<T>::value, bool>::type
+operator>=(T num, const basic_bigint<S, A>& b) { return b.compare(num) <= 0; }
+
+template <typename S, typename A>
+std::ostream& operator<<(std::ostream& os, const basic_bigint<S, A>& num) {
+    num.print(os);
+    return os;
+}
+
+#endif